@@ -0,0 +1,420 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memory.h"
+#include "error.h"
+#include "codeinfo.h"
+#include "cache.h"
+
+#define CACHEBUCKETS 1024
+
+typedef struct ENTRY {
+  char key[17];
+  long lastused;
+  int localslimit;
+  int length;
+  char *value;
+  struct ENTRY *next;
+} ENTRY;
+
+typedef struct BUFFER {
+  char *s;
+  int length, size;
+} BUFFER;
+
+char *cachefile;
+long cachegeneration;
+unsigned long cacheversion[2];
+ENTRY *cachetable[CACHEBUCKETS];
+int cacheentries;
+int cachehits, cachemisses;
+
+/****************  hashing  ****************/
+
+/* two 32-bit FNV-1a hashes with different offsets make up a 64-bit key */
+void cacheHash(unsigned long *h, char *s, int length)
+{ int i;
+  for (i=0; i<length; i++) {
+      h[0] = ((h[0]^(unsigned char)s[i])*16777619UL)&0xffffffffUL;
+      h[1] = ((h[1]^(unsigned char)s[i])*16777619UL)&0xffffffffUL;
+  }
+}
+
+void cacheHashString(unsigned long *h, char *s)
+{ if (s==NULL) s = "";
+  cacheHash(h,s,strlen(s)+1);
+}
+
+int cacheBucket(char *key)
+{ unsigned long h[2];
+  h[0] = h[1] = 0;
+  cacheHashString(h,key);
+  return h[0]%CACHEBUCKETS;
+}
+
+/****************  the external form of code  ****************/
+
+void bufferPut(BUFFER *b, char *s, int length)
+{ char *t;
+  if (b->length+length+1>b->size) {
+     b->size = 2*(b->length+length)+64;
+     t = Malloc(b->size);
+     if (b->length>0) memcpy(t,b->s,b->length);
+     b->s = t;
+  }
+  memcpy(b->s+b->length,s,length);
+  b->length += length;
+  b->s[b->length] = '\0';
+}
+
+void bufferInt(BUFFER *b, int i)
+{ char s[16];
+  sprintf(s," %i",i);
+  bufferPut(b,s,strlen(s));
+}
+
+void bufferString(BUFFER *b, char *s)
+{ bufferInt(b,strlen(s));
+  bufferPut(b," ",1);
+  bufferPut(b,s,strlen(s));
+}
+
+/* Writes c one instruction per line.  For a key, labels are renumbered in
+ * order of first appearance; for a value they keep their numbers and the
+ * names of the ones used come first.
+ */
+void cacheWrite(BUFFER *b, CODE *c, LABEL *labels, int labelcount, int value)
+{ int *number, count, l, i;
+  SWITCH *s;
+  CODE *p;
+  number = Malloc((labelcount+1)*sizeof(int));
+  for (l=0; l<labelcount; l++) number[l] = -1;
+  count = 0;
+  for (p=c; p!=NULL; p=p->next) {
+      if (codeinfo[p->kind].operand==CISWITCH) {
+         s = codeinfoSwitch(p);
+         for (i=0; i<=s->count; i++) {
+             l = i<s->count ? s->labels[i] : s->defaultlabel;
+             if (l>=0 && l<labelcount && number[l]==-1) number[l] = count++;
+         }
+      }
+      if (codeinfo[p->kind].operand!=CILABEL) continue;
+      l = codeinfoInt(p);
+      if (l>=0 && l<labelcount && number[l]==-1) number[l] = count++;
+  }
+  if (value) {
+     bufferInt(b,labelcount);
+     bufferInt(b,count);
+     for (l=0; l<labelcount; l++) {
+         if (number[l]==-1) continue;
+         bufferInt(b,l);
+         bufferString(b,labels[l].name);
+     }
+     bufferPut(b,"\n",1);
+  }
+  for (p=c; p!=NULL; p=p->next) {
+      bufferInt(b,p->kind);
+      switch (codeinfo[p->kind].operand) {
+        case CILOCAL:
+        case CIINT:
+             bufferInt(b,codeinfoInt(p));
+             break;
+        case CILABEL:
+             l = codeinfoInt(p);
+             bufferInt(b,value || l<0 || l>=labelcount ? l : number[l]);
+             break;
+        case CIIINC:
+             bufferInt(b,p->val.iincC.offset);
+             bufferInt(b,p->val.iincC.amount);
+             break;
+        case CISTRING:
+             bufferString(b,codeinfoString(p));
+             break;
+        case CISWITCH:
+             s = codeinfoSwitch(p);
+             bufferInt(b,s->count);
+             for (i=0; i<=s->count; i++) {
+                 if (i<s->count) bufferInt(b,s->keys[i]);
+                 l = i<s->count ? s->labels[i] : s->defaultlabel;
+                 bufferInt(b,value || l<0 || l>=labelcount ? l : number[l]);
+             }
+             break;
+      }
+      bufferPut(b,"\n",1);
+  }
+}
+
+char *cacheReadString(char **p)
+{ char *s;
+  int length;
+  length = strtol(*p,p,10);
+  (*p)++;
+  s = Malloc(length+1);
+  memcpy(s,*p,length);
+  s[length] = '\0';
+  *p += length;
+  return s;
+}
+
+/* the inverse of cacheWrite for a value */
+CODE *cacheRead(char *p, LABEL **labels, int *labelcount)
+{ CODE *c, *first, **last;
+  SWITCH *s;
+  int i, l, count;
+  *labelcount = strtol(p,&p,10);
+  *labels = Malloc((*labelcount+1)*sizeof(LABEL));
+  for (l=0; l<*labelcount; l++) {
+      (*labels)[l].name = "";
+      (*labels)[l].sources = 0;
+      (*labels)[l].position = NULL;
+  }
+  count = strtol(p,&p,10);
+  for (i=0; i<count; i++) {
+      l = strtol(p,&p,10);
+      (*labels)[l].name = cacheReadString(&p);
+  }
+  first = NULL;
+  last = &first;
+  for (;;) {
+    while (*p==' ' || *p=='\n') p++;
+    if (*p=='\0') break;
+    c = NEW(CODE);
+    c->kind = strtol(p,&p,10);
+    c->visited = 0;
+    switch (codeinfo[c->kind].operand) {
+      case CILOCAL:
+      case CIINT:
+           codeinfoSetInt(c,strtol(p,&p,10));
+           break;
+      case CILABEL:
+           l = strtol(p,&p,10);
+           codeinfoSetInt(c,l);
+           if (c->kind==labelCK) (*labels)[l].position = c;
+           else (*labels)[l].sources++;
+           break;
+      case CIIINC:
+           c->val.iincC.offset = strtol(p,&p,10);
+           c->val.iincC.amount = strtol(p,&p,10);
+           break;
+      case CISTRING:
+           codeinfoSetString(c,cacheReadString(&p));
+           break;
+      case CISWITCH:
+           s = NEW(SWITCH);
+           s->count = strtol(p,&p,10);
+           s->keys = Malloc((s->count+1)*sizeof(int));
+           s->labels = Malloc((s->count+1)*sizeof(int));
+           for (i=0; i<=s->count; i++) {
+               if (i<s->count) s->keys[i] = strtol(p,&p,10);
+               l = strtol(p,&p,10);
+               if (i<s->count) s->labels[i] = l;
+               else s->defaultlabel = l;
+               (*labels)[l].sources++;
+           }
+           if (c->kind==tableswitchCK) c->val.tableswitchC = s;
+           else c->val.lookupswitchC = s;
+           break;
+    }
+    c->next = NULL;
+    *last = c;
+    last = &c->next;
+  }
+  return first;
+}
+
+/****************  the table  ****************/
+
+ENTRY *cacheFind(char *key)
+{ ENTRY *e;
+  for (e=cachetable[cacheBucket(key)]; e!=NULL; e=e->next) {
+      if (strcmp(e->key,key)==0) return e;
+  }
+  return NULL;
+}
+
+void cacheInsert(ENTRY *e)
+{ int b;
+  b = cacheBucket(e->key);
+  e->next = cachetable[b];
+  cachetable[b] = e;
+  cacheentries++;
+}
+
+/* Loads the cache in file, which need not exist yet, and hashes the class
+ * hierarchy of p, with the members of every class, into the version.
+ */
+void cacheOpen(char *file, PROGRAM *p)
+{ FILE *f;
+  ENTRY *e;
+  CLASSFILE *c;
+  CONSTRUCTOR *k;
+  METHOD *m;
+  FIELD *d;
+  char key[17];
+  long lastused;
+  int localslimit, length;
+
+  cachefile = file;
+  cachegeneration = 0;
+  cacheentries = cachehits = cachemisses = 0;
+  cacheversion[0] = 2166136261UL;
+  cacheversion[1] = 3735928559UL;
+  sprintf(key,"%i",CACHEVERSION);
+  cacheMix(key);
+  for (; p!=NULL; p=p->next) {
+      for (c=p->classfile; c!=NULL; c=c->next) {
+          cacheMix(c->class->name);
+          cacheMix(c->class->parentname);
+          cacheMix(c->class->external ? "external" : "");
+          for (k=c->class->constructors; k!=NULL; k=k->next) {
+              cacheMix(k->signature);
+          }
+          for (m=c->class->methods; m!=NULL; m=m->next) {
+              cacheMix(m->name);
+              cacheMix(m->signature);
+              sprintf(key,"%i",m->modifier);
+              cacheMix(key);
+          }
+          for (d=c->class->fields; d!=NULL; d=d->next) {
+              cacheMix(d->name);
+              sprintf(key,"%i",d->type->kind);
+              cacheMix(key);
+              cacheMix(d->type->kind==refK ? d->type->name : "");
+          }
+      }
+  }
+
+  f = fopen(file,"r");
+  if (f==NULL) return;
+  if (fscanf(f,"JOOS cache %ld\n",&cachegeneration)!=1) {
+     reportStrGlobalError("%s is not an optimization cache",file);
+     fclose(f);
+     return;
+  }
+  while (fscanf(f,"%16s %ld %i %i",key,&lastused,&localslimit,&length)==4) {
+    if (getc(f)!='\n' || length<0) break;
+    e = NEW(ENTRY);
+    strcpy(e->key,key);
+    e->lastused = lastused;
+    e->localslimit = localslimit;
+    e->length = length;
+    e->value = Malloc(length+1);
+    if (fread(e->value,1,length,f)!=length) break;
+    e->value[length] = '\0';
+    cacheInsert(e);
+  }
+  fclose(f);
+}
+
+/* adds s to the version, which every key depends on */
+void cacheMix(char *s)
+{ if (cachefile!=NULL) cacheHashString(cacheversion,s);
+}
+
+char *cacheKey(CODE *c, LABEL *labels, int labelcount, CLASS *class,
+               char *signature, int localslimit, int isstatic)
+{ BUFFER b;
+  unsigned long h[2];
+  char *key;
+  if (cachefile==NULL) return NULL;
+  b.s = NULL;
+  b.length = b.size = 0;
+  bufferString(&b,class->name);
+  bufferString(&b,signature);
+  bufferInt(&b,localslimit);
+  bufferInt(&b,isstatic);
+  bufferPut(&b,"\n",1);
+  cacheWrite(&b,c,labels,labelcount,0);
+  h[0] = cacheversion[0];
+  h[1] = cacheversion[1];
+  cacheHash(h,b.s,b.length);
+  key = Malloc(17);
+  sprintf(key,"%08lx%08lx",h[0],h[1]);
+  return key;
+}
+
+int cacheFetch(char *key, CODE **c, LABEL **labels, int *labelcount,
+               int *localslimit)
+{ ENTRY *e;
+  if (key==NULL) return 0;
+  e = cacheFind(key);
+  if (e==NULL) {
+     cachemisses++;
+     return 0;
+  }
+  *c = cacheRead(e->value,labels,labelcount);
+  *localslimit = e->localslimit;
+  e->lastused = cachegeneration+1;
+  cachehits++;
+  return 1;
+}
+
+void cacheStore(char *key, CODE *c, LABEL *labels, int labelcount,
+                int localslimit)
+{ ENTRY *e;
+  BUFFER b;
+  if (key==NULL || cacheFind(key)!=NULL) return;
+  b.s = NULL;
+  b.length = b.size = 0;
+  cacheWrite(&b,c,labels,labelcount,1);
+  e = NEW(ENTRY);
+  strcpy(e->key,key);
+  e->lastused = cachegeneration+1;
+  e->localslimit = localslimit;
+  e->length = b.length;
+  e->value = b.s;
+  cacheInsert(e);
+}
+
+int cacheCompare(const void *a, const void *b)
+{ long x, y;
+  x = (*(ENTRY **)a)->lastused;
+  y = (*(ENTRY **)b)->lastused;
+  return x>y ? -1 : x<y ? 1 : 0;
+}
+
+/* writes back the CACHEENTRIES most recently used entries */
+void cacheClose()
+{ FILE *f;
+  ENTRY **all, *e;
+  char *temp;
+  int i, n;
+  if (cachefile==NULL) return;
+  all = Malloc((cacheentries+1)*sizeof(ENTRY *));
+  n = 0;
+  for (i=0; i<CACHEBUCKETS; i++) {
+      for (e=cachetable[i]; e!=NULL; e=e->next) all[n++] = e;
+  }
+  qsort(all,n,sizeof(ENTRY *),cacheCompare);
+  if (n>CACHEENTRIES) n = CACHEENTRIES;
+
+  temp = Malloc(strlen(cachefile)+5);
+  sprintf(temp,"%s.tmp",cachefile);
+  f = fopen(temp,"w");
+  if (f==NULL) {
+     reportStrGlobalError("Unable to write optimization cache %s",cachefile);
+     return;
+  }
+  fprintf(f,"JOOS cache %ld\n",cachegeneration+1);
+  for (i=0; i<n; i++) {
+      fprintf(f,"%s %ld %i %i\n",all[i]->key,all[i]->lastused,
+              all[i]->localslimit,all[i]->length);
+      fwrite(all[i]->value,1,all[i]->length,f);
+  }
+  fclose(f);
+  if (rename(temp,cachefile)!=0) {
+     reportStrGlobalError("Unable to write optimization cache %s",cachefile);
+  }
+}
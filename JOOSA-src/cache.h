@@ -0,0 +1,40 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* The optimization cache named with -C.  A method is looked up by a hash of
+ * its unoptimized code, with labels numbered by first appearance, together
+ * with everything else the optimizer reads: its class, signature and locals,
+ * the class hierarchy with the members of each class, the patterns and the
+ * superoptimizer rules.  A hit supplies the optimized code, labels and
+ * locals limit.
+ *
+ * CACHEVERSION must be bumped whenever a pattern or pass changes meaning
+ * without changing its name.  At most CACHEENTRIES methods are kept; the
+ * least recently used ones are dropped first.
+ */
+
+#define CACHEVERSION 19
+#define CACHEENTRIES 4096
+
+extern int cachehits, cachemisses;
+
+void cacheOpen(char *file, PROGRAM *p);
+void cacheMix(char *s);
+char *cacheKey(CODE *c, LABEL *labels, int labelcount, CLASS *class,
+               char *signature, int localslimit, int isstatic);
+int cacheFetch(char *key, CODE **c, LABEL **labels, int *labelcount,
+               int *localslimit);
+void cacheStore(char *key, CODE *c, LABEL *labels, int labelcount,
+                int localslimit);
+void cacheClose();
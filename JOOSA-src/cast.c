@@ -0,0 +1,267 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "symbol.h"
+#include "flow.h"
+#include "cha.h"
+#include "cast.h"
+
+/* A reference is described by an index into casttypes, the most precise
+ * class known to contain it, together with three flags.  Index 1 is the
+ * type of null, which is a subclass of everything.  Only a type the
+ * verifier also infers, from a descriptor, a new or a checkcast, can stand
+ * in for a checkcast; the verifier does not narrow a local after a test,
+ * so a type learnt from instanceof only folds other instanceofs.
+ *
+ * An int produced by "aload k; instanceof C" is described by TEST, k and C;
+ * it is nonzero exactly when local k is a non-null instance of C, as long as
+ * local k is not overwritten.  All other ints are UNKNOWN.
+ */
+
+#define UNKNOWN 0
+#define NONNULL 1          /* never null */
+#define EXACT 2            /* if not null, an instance of exactly this class */
+#define VERIFIED 4         /* the verifier infers this type too */
+#define NULLTYPE 1
+#define TYPE(v) ((v)>>3)
+#define MAKE(t,flags) ((t)==0 ? UNKNOWN : ((t)<<3)|(flags))
+
+#define TEST 0x40000000
+#define TESTLOCAL(v) (((v)>>16)&0x3fff)
+#define TESTTYPE(v) ((v)&0xffff)
+#define MAKETEST(k,t) (TEST|((k)<<16)|(t))
+
+CLASS **casttypes;
+int casttypecount, casttypesize;
+
+int castremoved, castfolded;
+
+int castIndex(CLASS *c)
+{ CLASS **t;
+  int i;
+  if (c==NULL) return 0;
+  for (i=2; i<casttypecount; i++) {
+      if (casttypes[i]==c) return i;
+  }
+  if (casttypecount==casttypesize) {
+     casttypesize = 2*casttypesize+16;
+     t = Malloc(casttypesize*sizeof(CLASS *));
+     for (i=0; i<casttypecount; i++) t[i] = casttypes[i];
+     casttypes = t;
+  }
+  if (casttypecount<2) casttypecount = 2;
+  casttypes[casttypecount] = c;
+  return casttypecount++;
+}
+
+int castName(char *classname)
+{ return castIndex(chaClass(classname));
+}
+
+/* the class of a field or return descriptor such as "Ljava/lang/String;" */
+int castDescriptor(char *d)
+{ char *s;
+  int t;
+  if (d==NULL || *d!='L' || strchr(d,';')==NULL) return 0;
+  s = Malloc(strlen(d));
+  strncpy(s,d+1,strchr(d,';')-d-1);
+  s[strchr(d,';')-d-1] = '\0';
+  t = castName(s);
+  return t;
+}
+
+int castSubtype(int sub, int super)
+{ if (sub==NULLTYPE) return 1;
+  if (super==NULLTYPE) return 0;
+  return subClass(casttypes[sub],casttypes[super]);
+}
+
+int castJoin(int a, int b)
+{ CLASS *c;
+  if (a==b) return a;
+  if (a==UNKNOWN || b==UNKNOWN || (a&TEST) || (b&TEST)) return UNKNOWN;
+  if (TYPE(a)==NULLTYPE) return MAKE(TYPE(b),b&(EXACT|VERIFIED));
+  if (TYPE(b)==NULLTYPE) return MAKE(TYPE(a),a&(EXACT|VERIFIED));
+  if (TYPE(a)==TYPE(b)) return a&b;
+  for (c=casttypes[TYPE(a)]; c!=NULL; c=c->parent) {
+      if (subClass(casttypes[TYPE(b)],c)) {
+         return MAKE(castIndex(c),a&b&(NONNULL|VERIFIED));
+      }
+  }
+  return UNKNOWN;
+}
+
+/* what is known about v once it has passed a cast or test to t, which
+ * adds flags, NONNULL and/or VERIFIED
+ */
+int castRefine(int v, int t, int flags)
+{ if (t==0) return v;
+  if (v==UNKNOWN || (v&TEST)) return MAKE(t,flags);
+  if (TYPE(v)==NULLTYPE) return v;
+  if (castSubtype(TYPE(v),t) && ((v&VERIFIED) || !(flags&VERIFIED))) {
+     return v|(flags&NONNULL);
+  }
+  return MAKE(t,(v&NONNULL)|flags);
+}
+
+/* the value of "instanceof t" on v: 1, 0, or -1 if not known.
+ * External classes may have superclasses that the extern declarations
+ * leave out, so only the hierarchy below a JOOS class can prove a no.
+ */
+int castDecide(int v, int t)
+{ if (t==0 || v==UNKNOWN || (v&TEST)) return -1;
+  if (TYPE(v)==NULLTYPE) return 0;
+  if (castSubtype(TYPE(v),t)) return (v&NONNULL) ? 1 : -1;
+  if (casttypes[t]->external) return -1;
+  if (v&EXACT) return 0;
+  if (!casttypes[TYPE(v)]->external && !castSubtype(t,TYPE(v))) return 0;
+  return -1;
+}
+
+/* a store to local k invalidates every test on it */
+void castKill(FLOW *f, int *s, int k)
+{ int j;
+  for (j=0; j<FLOWHEIGHT(s); j++) {
+      if ((FLOWSTACK(f,s,j)&TEST) && TESTLOCAL(FLOWSTACK(f,s,j))==k) {
+         FLOWSTACK(f,s,j) = UNKNOWN;
+      }
+  }
+  for (j=0; j<f->localslimit; j++) {
+      if ((FLOWLOCAL(f,s,j)&TEST) && TESTLOCAL(FLOWLOCAL(f,s,j))==k) {
+         FLOWLOCAL(f,s,j) = UNKNOWN;
+      }
+  }
+}
+
+void castTransfer(FLOW *f, int i, int *fall, int *taken)
+{ CODE *c;
+  int h, v, k;
+  char *d;
+  c = f->code[i];
+  h = FLOWHEIGHT(fall);
+  v = h>0 ? FLOWTOP(f,fall,1) : UNKNOWN;
+  switch (c->kind) {
+    case newCK:
+         FLOWSTACK(f,fall,h) = MAKE(castName(c->val.newC),NONNULL|EXACT|VERIFIED);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case ldc_stringCK:
+         FLOWSTACK(f,fall,h) = MAKE(castName("java/lang/String"),NONNULL|EXACT|VERIFIED);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case aconst_nullCK:
+         FLOWSTACK(f,fall,h) = MAKE(NULLTYPE,VERIFIED);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case checkcastCK:
+         FLOWTOP(f,fall,1) = castRefine(v,castName(c->val.checkcastC),VERIFIED);
+         break;
+    case instanceofCK:
+         FLOWTOP(f,fall,1) = UNKNOWN;
+         if (i>0 && f->code[i-1]->kind==aloadCK &&
+             f->code[i-1]->val.aloadC<0x4000 &&
+             castName(c->val.instanceofC)!=0) {
+            FLOWTOP(f,fall,1) = MAKETEST(f->code[i-1]->val.aloadC,
+                                         castName(c->val.instanceofC));
+         }
+         break;
+    case astoreCK:
+         flowDefault(f,i,fall,UNKNOWN);
+         castKill(f,fall,c->val.astoreC);
+         break;
+    case istoreCK:
+         flowDefault(f,i,fall,UNKNOWN);
+         castKill(f,fall,c->val.istoreC);
+         break;
+    case getfieldCK:
+         flowDefault(f,i,fall,UNKNOWN);
+         d = strchr(c->val.getfieldC,' ');
+         if (d!=NULL) FLOWTOP(f,fall,1) = MAKE(castDescriptor(d+1),VERIFIED);
+         break;
+    case invokevirtualCK:
+    case invokenonvirtualCK:
+         flowDefault(f,i,fall,UNKNOWN);
+         d = strchr(c->kind==invokevirtualCK ? c->val.invokevirtualC
+                                             : c->val.invokenonvirtualC,')');
+         if (d!=NULL && d[1]=='L') {
+            FLOWTOP(f,fall,1) = MAKE(castDescriptor(d+1),VERIFIED);
+         }
+         break;
+    default:
+         flowDefault(f,i,fall,UNKNOWN);
+         break;
+  }
+  memcpy(taken,fall,f->width*sizeof(int));
+  if ((c->kind==ifeqCK || c->kind==ifneCK) && (v&TEST)) {
+     k = TESTLOCAL(v);
+     if (c->kind==ifeqCK) {
+        FLOWLOCAL(f,fall,k) = castRefine(FLOWLOCAL(f,fall,k),TESTTYPE(v),NONNULL);
+     } else {
+        FLOWLOCAL(f,taken,k) = castRefine(FLOWLOCAL(f,taken,k),TESTTYPE(v),NONNULL);
+     }
+  }
+}
+
+/* Deletes checkcasts on values the verifier already knows to be of the
+ * target class and replaces instanceofs with a known outcome by
+ * "pop; ldc_int k", which the patterns then clean up further.  this is NULL
+ * for static methods.
+ */
+int castCODE(CODE *c, CLASS *this, FORMAL *formals, int localslimit)
+{ FLOW *f;
+  int *s, i, d, t, change;
+  FORMAL *p;
+
+  f = flowCODE(c,localslimit);
+  s = flowEntry(f,UNKNOWN);
+  if (this!=NULL && localslimit>0) {
+     FLOWLOCAL(f,s,0) = MAKE(castIndex(this),NONNULL|VERIFIED);
+  }
+  for (p=formals; p!=NULL; p=p->next) {
+      if (p->type->kind==refK && p->offset<localslimit) {
+         FLOWLOCAL(f,s,p->offset) = MAKE(castIndex(p->type->class),VERIFIED);
+      }
+  }
+  flowSolve(f,s,castJoin,castTransfer);
+
+  change = 0;
+  for (i=0; i<f->count; i++) {
+      s = flowIn(f,i);
+      if (s==NULL) continue;
+      switch (f->code[i]->kind) {
+        case checkcastCK:
+             t = castName(f->code[i]->val.checkcastC);
+             if (t!=0 && (FLOWTOP(f,s,1)&VERIFIED) && !(FLOWTOP(f,s,1)&TEST) &&
+                 castSubtype(TYPE(FLOWTOP(f,s,1)),t)) {
+                f->code[i]->kind = nopCK;
+                castremoved++;
+                change = 1;
+             }
+             break;
+        case instanceofCK:
+             d = castDecide(FLOWTOP(f,s,1),castName(f->code[i]->val.instanceofC));
+             if (d!=-1) {
+                f->code[i]->kind = popCK;
+                f->code[i]->next = makeCODEldc_int(d,f->code[i]->next);
+                castfolded++;
+                change = 1;
+             }
+             break;
+        default:
+             break;
+      }
+  }
+  return change;
+}
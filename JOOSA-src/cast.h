@@ -0,0 +1,21 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Flow-sensitive static types of references, used to delete checkcasts
+ * that always succeed and to fold instanceofs whose outcome is known.
+ */
+
+extern int castremoved, castfolded;
+
+int castCODE(CODE *c, CLASS *this, FORMAL *formals, int localslimit);
@@ -0,0 +1,298 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "symbol.h"
+#include "flow.h"
+#include "optimize.h"
+#include "cha.h"
+
+OVERRIDES *chatable[HashSize];
+
+typedef struct CLASSLIST {
+  CLASS *class;
+  char *classname;
+  struct CLASSLIST *next;
+} CLASSLIST;
+
+CLASSLIST *chaclasses;
+
+int chaHash(char *str)
+{ unsigned int hash = 0;
+  while (*str) hash = (hash << 1) + *str++;
+  return hash % HashSize;
+}
+
+/* the internal name of a class, as codeClassname in code.c builds it */
+char *chaClassname(CLASS *c)
+{ char *s;
+  int i;
+  if (c->package==NULL) return c->name;
+  s = Malloc(strlen(c->package)+strlen(c->name)+2);
+  sprintf(s,"%s/%s",c->package,c->name);
+  for (i=0; i<strlen(c->package); i++) {
+      if (s[i]=='.') s[i] = '/';
+  }
+  return s;
+}
+
+OVERRIDES *chaOverrides(char *name, int create)
+{ OVERRIDES *o;
+  int i = chaHash(name);
+  for (o = chatable[i]; o; o = o->next) {
+      if (strcmp(o->name,name)==0) return o;
+  }
+  if (!create) return NULL;
+  o = NEW(OVERRIDES);
+  o->name = name;
+  o->implementations = NULL;
+  o->next = chatable[i];
+  chatable[i] = o;
+  return o;
+}
+
+void chaBuildMETHOD(METHOD *m, CLASS *c)
+{ OVERRIDES *o;
+  IMPLEMENTATION *i;
+  if (m!=NULL) {
+     chaBuildMETHOD(m->next,c);
+     if (!c->external) {
+        o = chaOverrides(m->name,1);
+        i = NEW(IMPLEMENTATION);
+        i->class = c;
+        i->method = m;
+        i->next = o->implementations;
+        o->implementations = i;
+     }
+  }
+}
+
+void chaBuildCLASSFILE(CLASSFILE *c)
+{ CLASSLIST *l;
+  if (c!=NULL) {
+     chaBuildCLASSFILE(c->next);
+     l = NEW(CLASSLIST);
+     l->class = c->class;
+     l->classname = chaClassname(c->class);
+     l->next = chaclasses;
+     chaclasses = l;
+     chaBuildMETHOD(c->class->methods,c->class);
+  }
+}
+
+void chaBuildPROGRAM(PROGRAM *p)
+{ int i;
+  if (p==NULL) return;
+  for (i=0; i<HashSize; i++) chatable[i] = NULL;
+  chaclasses = NULL;
+  for (; p!=NULL; p=p->next) chaBuildCLASSFILE(p->classfile);
+}
+
+IMPLEMENTATION *chaImplementations(char *name)
+{ OVERRIDES *o;
+  o = chaOverrides(name,0);
+  if (o==NULL) return NULL;
+  return o->implementations;
+}
+
+CLASS *chaClass(char *classname)
+{ CLASSLIST *l;
+  for (l=chaclasses; l!=NULL; l=l->next) {
+      if (strcmp(l->classname,classname)==0) return l->class;
+  }
+  return NULL;
+}
+
+/* splits "Class/name(signature)" into the class and the method name */
+int chaSplit(char *invoke, CLASS **c, char **name)
+{ char *paren, *slash, *s;
+  paren = strchr(invoke,'(');
+  if (paren==NULL) return 0;
+  for (slash=paren; slash>invoke && *slash!='/'; slash--);
+  if (slash==invoke) return 0;
+  s = Malloc(slash-invoke+1);
+  strncpy(s,invoke,slash-invoke);
+  s[slash-invoke] = '\0';
+  *c = chaClass(s);
+  *name = Malloc(paren-slash);
+  strncpy(*name,slash+1,paren-slash-1);
+  (*name)[paren-slash-1] = '\0';
+  return *c!=NULL;
+}
+
+int chaAddTarget(IMPLEMENTATION **targets, CLASS *c, METHOD *m)
+{ IMPLEMENTATION *i;
+  for (i=*targets; i!=NULL; i=i->next) {
+      if (i->method==m) return 0;
+  }
+  i = NEW(IMPLEMENTATION);
+  i->class = c;
+  i->method = m;
+  i->next = *targets;
+  *targets = i;
+  return 1;
+}
+
+/* The implementations of name that a call on a receiver of static type c
+ * may reach: the one c inherits or declares, plus every override in a
+ * subclass of c.  Returns the number of targets, or -1 if c is external,
+ * since the library may contain subclasses we do not know about.
+ */
+int chaTargets(CLASS *c, char *name, IMPLEMENTATION **targets)
+{ SYMBOL *s;
+  IMPLEMENTATION *i;
+  int count;
+  *targets = NULL;
+  if (c==NULL || c->external) return -1;
+  count = 0;
+  s = lookupHierarchy(name,c);
+  if (s==NULL || s->kind!=methodSym) return -1;
+  if (s->val.methodS->modifier!=abstractMod) {
+     count += chaAddTarget(targets,lookupHierarchyClass(name,c),s->val.methodS);
+  }
+  for (i=chaImplementations(name); i!=NULL; i=i->next) {
+      if (i->class!=c && subClass(i->class,c) &&
+          i->method->modifier!=abstractMod) {
+         count += chaAddTarget(targets,i->class,i->method);
+      }
+  }
+  return count;
+}
+
+/****************  devirtualization of calls on this  ****************/
+
+#define THIS 1
+#define UNKNOWN 0
+
+int chaJoin(int a, int b)
+{ return a==b ? a : UNKNOWN;
+}
+
+void chaTransfer(FLOW *f, int i, int *fall, int *taken)
+{ flowDefault(f,i,fall,UNKNOWN);
+  memcpy(taken,fall,f->width*sizeof(int));
+}
+
+int chaArguments(char *sig)
+{ int a = 0;
+  sig = strchr(sig,'(')+1;
+  while (*sig!=')') {
+    a++;
+    if (*sig=='L') sig = strchr(sig,';');
+    sig++;
+  }
+  return a;
+}
+
+CLASS *chacurrentclass;
+int chadirect, chamonomorphic, chapolymorphic, chaexternal;
+
+/* Rewrites every invokevirtual whose receiver is this and which has a
+ * single possible target into an invokenonvirtual of that target.  The JVM
+ * only allows invokenonvirtual on a receiver of the current class, so
+ * other monomorphic sites stay virtual; their callee is still marked as an
+ * inlining candidate.  Returns 1 if it rewrote a call, which it does not
+ * do once -fopt-bisect-limit is reached.
+ */
+int chaCODE(CODE *c, int localslimit, char *name)
+{ FLOW *f;
+  int *s, i, count, allowed, change;
+  CLASS *class;
+  char *method, *sig;
+  IMPLEMENTATION *targets;
+
+  allowed = optiAllowed();
+  change = 0;
+  f = flowCODE(c,localslimit);
+  s = flowEntry(f,UNKNOWN);
+  FLOWLOCAL(f,s,0) = THIS;
+  flowSolve(f,s,chaJoin,chaTransfer);
+  for (i=0; i<f->count; i++) {
+      s = flowIn(f,i);
+      if (s==NULL || f->code[i]->kind!=invokevirtualCK) continue;
+      if (!chaSplit(f->code[i]->val.invokevirtualC,&class,&method)) continue;
+      sig = strchr(f->code[i]->val.invokevirtualC,'(');
+      if (FLOWTOP(f,s,chaArguments(sig)+1)==THIS) class = chacurrentclass;
+      count = chaTargets(class,method,&targets);
+      if (count==-1) {
+         chaexternal++;
+      } else if (count==1) {
+         targets->method->inlinecandidate = 1;
+         if (allowed && FLOWTOP(f,s,chaArguments(sig)+1)==THIS &&
+             !targets->class->external &&
+             subClass(chacurrentclass,targets->class)) {
+            f->code[i]->kind = invokenonvirtualCK;
+            f->code[i]->val.invokenonvirtualC =
+                Malloc(strlen(targets->class->signature)+strlen(method)+strlen(sig)+2);
+            sprintf(f->code[i]->val.invokenonvirtualC,"%s/%s%s",
+                    targets->class->signature,method,sig);
+            chadirect++;
+            change = 1;
+         } else {
+            chamonomorphic++;
+         }
+      } else if (count>1) {
+         chapolymorphic++;
+         printf("  %s.%s: %s has %i targets\n",
+                chacurrentclass->name,name,f->code[i]->val.invokevirtualC,count);
+      }
+  }
+  return change;
+}
+
+void chaPROGRAM(PROGRAM *p)
+{ chaBuildPROGRAM(p);
+  chadirect = chamonomorphic = chapolymorphic = chaexternal = 0;
+  printf("\nUnresolved call sites:\n");
+  for (; p!=NULL; p=p->next) chaCLASSFILE(p->classfile);
+  printf("direct: %i, monomorphic: %i, polymorphic: %i, external: %i\n",
+         chadirect,chamonomorphic,chapolymorphic,chaexternal);
+}
+
+void chaCLASSFILE(CLASSFILE *c)
+{ if (c!=NULL) {
+     chaCLASSFILE(c->next);
+     chaCLASS(c->class);
+  }
+}
+
+void chaCLASS(CLASS *c)
+{ if (!c->external) {
+     chacurrentclass = c;
+     chaCONSTRUCTOR(c->constructors);
+     chaMETHOD(c->methods);
+  }
+}
+
+void chaCONSTRUCTOR(CONSTRUCTOR *c)
+{ if (c!=NULL) {
+     chaCONSTRUCTOR(c->next);
+     optiName(chacurrentclass->name,"<init>");
+     if (chaCODE(c->opcodes,c->localslimit,c->name)) {
+        optiRewrite("chaCODE",NULL);
+     }
+  }
+}
+
+void chaMETHOD(METHOD *m)
+{ if (m!=NULL) {
+     chaMETHOD(m->next);
+     if (m->modifier!=staticMod && m->modifier!=abstractMod) {
+        optiName(chacurrentclass->name,m->name);
+        if (chaCODE(m->opcodes,m->localslimit,m->name)) {
+           optiRewrite("chaCODE",NULL);
+        }
+     }
+  }
+}
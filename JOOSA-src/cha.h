@@ -0,0 +1,43 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Class hierarchy analysis.  For every method name (JOOS requires an
+ * overriding method to have the same signature, so the name identifies the
+ * signature) we record every implementation found in a non-external class.
+ */
+
+typedef struct IMPLEMENTATION {
+  struct CLASS *class;
+  struct METHOD *method;
+  struct IMPLEMENTATION *next;
+} IMPLEMENTATION;
+
+typedef struct OVERRIDES {
+  char *name;
+  IMPLEMENTATION *implementations;
+  struct OVERRIDES *next;
+} OVERRIDES;
+
+void chaBuildPROGRAM(PROGRAM *p);
+IMPLEMENTATION *chaImplementations(char *name);
+CLASS *chaClass(char *classname);
+int chaTargets(CLASS *c, char *name, IMPLEMENTATION **targets);
+int chaSplit(char *invoke, CLASS **c, char **name);
+
+void chaPROGRAM(PROGRAM *p);
+void chaCLASSFILE(CLASSFILE *c);
+void chaCLASS(CLASS *c);
+void chaCONSTRUCTOR(CONSTRUCTOR *c);
+void chaMETHOD(METHOD *m);
+int chaCODE(CODE *c, int localslimit, char *name);
@@ -74,64 +74,103 @@ void code_iadd()
 { appendCODE(makeCODEiadd(NULL));
 }
 
+/* every jump helper counts itself as a source of its label */
+void code_labels(LABEL *labels, int count)
+{ int i;
+  for (i=0; i<count; i++) labels[i].sources = 0;
+  currentlabels = labels;
+}
+
 CODE *code_label(char *name, int label)
 { currentlabels[label].name = name;
-  currentlabels[label].sources = 1;
   appendCODE(makeCODElabel(label,NULL));
   currentlabels[label].position = currenttail;
   return currenttail;
 }
 
 void code_goto(int label)
-{ appendCODE(makeCODEgoto(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEgoto(label,NULL));
 }
 
 void code_ifeq(int label)
-{ appendCODE(makeCODEifeq(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEifeq(label,NULL));
 }
 
 void code_ifne(int label)
-{ appendCODE(makeCODEifne(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEifne(label,NULL));
+}
+
+void code_iflt(int label)
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEiflt(label,NULL));
+}
+
+void code_ifge(int label)
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEifge(label,NULL));
+}
+
+void code_ifgt(int label)
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEifgt(label,NULL));
+}
+
+void code_ifle(int label)
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEifle(label,NULL));
 }
 
 void code_if_acmpeq(int label)
-{ appendCODE(makeCODEif_acmpeq(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEif_acmpeq(label,NULL));
 }
 
 void code_if_acmpne(int label)
-{ appendCODE(makeCODEif_acmpne(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEif_acmpne(label,NULL));
 }
 
 void code_ifnull(int label)
-{ appendCODE(makeCODEifnull(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEifnull(label,NULL));
 }
 
 void code_ifnonnull(int label)
-{ appendCODE(makeCODEifnonnull(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEifnonnull(label,NULL));
 }
 
 void code_if_icmpeq(int label)
-{ appendCODE(makeCODEif_icmpeq(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEif_icmpeq(label,NULL));
 }
 
 void code_if_icmpgt(int label)
-{ appendCODE(makeCODEif_icmpgt(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEif_icmpgt(label,NULL));
 }
 
 void code_if_icmplt(int label)
-{ appendCODE(makeCODEif_icmplt(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEif_icmplt(label,NULL));
 }
 
 void code_if_icmple(int label)
-{ appendCODE(makeCODEif_icmple(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEif_icmple(label,NULL));
 }
 
 void code_if_icmpge(int label)
-{ appendCODE(makeCODEif_icmpge(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEif_icmpge(label,NULL));
 }
 
 void code_if_icmpne(int label)
-{ appendCODE(makeCODEif_icmpne(label,NULL));
+{ currentlabels[label].sources++;
+  appendCODE(makeCODEif_icmpne(label,NULL));
 }
 
 void code_ireturn()
@@ -325,7 +364,7 @@ void codeCONSTRUCTOR(CONSTRUCTOR *c)
      codeCONSTRUCTOR(c->next);
      currentcode = NULL;
      c->labels = Malloc(c->labelcount*sizeof(LABEL));
-     currentlabels = c->labels;
+     code_labels(c->labels,c->labelcount);
      codeSTATEMENT(c->statements);
      code_return();
      c->opcodes = currentcode;
@@ -338,7 +377,7 @@ void codeMETHOD(METHOD *m)
      codeMETHOD(m->next);
      currentcode = NULL;
      m->labels = Malloc(m->labelcount*sizeof(LABEL));
-     currentlabels = m->labels;
+     code_labels(m->labels,m->labelcount);
      codeSTATEMENT(m->statements);
      if (m->returntype->kind==voidK) {
         code_return();
@@ -381,14 +420,12 @@ void codeSTATEMENT(STATEMENT *s)
             codeSTATEMENT(s->val.sequenceS.second);
             break;
        case ifK:
-            codeEXP(s->val.ifS.condition);
-            code_ifeq(s->val.ifS.stoplabel);
+            codeCOND(s->val.ifS.condition,s->val.ifS.stoplabel,0);
             codeSTATEMENT(s->val.ifS.body);
             code_label("stop",s->val.ifS.stoplabel);
             break;
        case ifelseK:
-            codeEXP(s->val.ifelseS.condition);
-            code_ifeq(s->val.ifelseS.elselabel);
+            codeCOND(s->val.ifelseS.condition,s->val.ifelseS.elselabel,0);
             codeSTATEMENT(s->val.ifelseS.thenpart);
             code_goto(s->val.ifelseS.stoplabel);
             code_label("else",s->val.ifelseS.elselabel);
@@ -397,8 +434,7 @@ void codeSTATEMENT(STATEMENT *s)
             break;
        case whileK:
             code_label("start",s->val.whileS.startlabel);
-            codeEXP(s->val.whileS.condition);
-            code_ifeq(s->val.whileS.stoplabel);
+            codeCOND(s->val.whileS.condition,s->val.whileS.stoplabel,0);
             codeSTATEMENT(s->val.whileS.body);
             code_goto(s->val.whileS.startlabel);
             code_label("stop",s->val.whileS.stoplabel);
@@ -533,9 +569,8 @@ void codeEXP(EXP *e)
          code_label("stop",e->val.eqE.stoplabel);
          break;
     case ltK:
-         codeEXP(e->val.ltE.left);
-         codeEXP(e->val.ltE.right);
-         code_if_icmplt(e->val.ltE.truelabel);
+         codeCOMPARISON(ltK,e->val.ltE.left,e->val.ltE.right,
+                        e->val.ltE.truelabel,1);
          code_ldc_int(0);
          code_goto(e->val.ltE.stoplabel);
          code_label("true",e->val.ltE.truelabel);
@@ -543,9 +578,8 @@ void codeEXP(EXP *e)
          code_label("stop",e->val.ltE.stoplabel);
          break;
     case gtK:
-         codeEXP(e->val.gtE.left);
-         codeEXP(e->val.gtE.right);
-         code_if_icmpgt(e->val.gtE.truelabel);
+         codeCOMPARISON(gtK,e->val.gtE.left,e->val.gtE.right,
+                        e->val.gtE.truelabel,1);
          code_ldc_int(0);
          code_goto(e->val.gtE.stoplabel);
          code_label("true",e->val.gtE.truelabel);
@@ -553,9 +587,8 @@ void codeEXP(EXP *e)
          code_label("stop",e->val.gtE.stoplabel);
          break;
     case leqK:
-         codeEXP(e->val.leqE.left);
-         codeEXP(e->val.leqE.right);
-         code_if_icmple(e->val.leqE.truelabel);
+         codeCOMPARISON(leqK,e->val.leqE.left,e->val.leqE.right,
+                        e->val.leqE.truelabel,1);
          code_ldc_int(0);
          code_goto(e->val.leqE.stoplabel);
          code_label("true",e->val.leqE.truelabel);
@@ -563,9 +596,8 @@ void codeEXP(EXP *e)
          code_label("stop",e->val.leqE.stoplabel);
          break;
     case geqK:
-         codeEXP(e->val.geqE.left);
-         codeEXP(e->val.geqE.right);
-         code_if_icmpge(e->val.geqE.truelabel);
+         codeCOMPARISON(geqK,e->val.geqE.left,e->val.geqE.right,
+                        e->val.geqE.truelabel,1);
          code_ldc_int(0);
          code_goto(e->val.geqE.stoplabel);
          code_label("true",e->val.geqE.truelabel);
@@ -592,12 +624,17 @@ void codeEXP(EXP *e)
          code_instanceof(codeClassname(e->val.instanceofE.class));
          break;
     case plusK:
-         codeEXP(e->val.plusE.left);
-         codeEXP(e->val.plusE.right);
          if (e->type->kind==intK) {
+            codeEXP(e->val.plusE.left);
+            codeEXP(e->val.plusE.right);
             code_iadd();
-         } else {
+         } else if (codeOperands(e)<3) {
+            codeEXP(e->val.plusE.left);
+            codeEXP(e->val.plusE.right);
             code_invokevirtual("java/lang/String/concat(Ljava/lang/String;)Ljava/lang/String;");
+         } else {
+            codeCONCAT(e);
+            code_invokevirtual("java/lang/StringBuffer/toString()Ljava/lang/String;");
          }
          break;
     case minusK:
@@ -727,6 +764,214 @@ void codeEXP(EXP *e)
   }
 }
 
+/* Jumps to label if the condition e evaluates to sense and falls through
+ * otherwise, without materializing the boolean.
+ */
+void codeCOND(EXP *e, int label, int sense)
+{ switch (e->kind) {
+    case notK:
+         codeCOND(e->val.notE.not,label,!sense);
+         break;
+    case andK:
+         if (sense) {
+            codeCOND(e->val.andE.left,e->val.andE.falselabel,0);
+            codeCOND(e->val.andE.right,label,1);
+            code_label("false",e->val.andE.falselabel);
+         } else {
+            codeCOND(e->val.andE.left,label,0);
+            codeCOND(e->val.andE.right,label,0);
+         }
+         break;
+    case orK:
+         if (sense) {
+            codeCOND(e->val.orE.left,label,1);
+            codeCOND(e->val.orE.right,label,1);
+         } else {
+            codeCOND(e->val.orE.left,e->val.orE.truelabel,1);
+            codeCOND(e->val.orE.right,label,0);
+            code_label("true",e->val.orE.truelabel);
+         }
+         break;
+    case boolconstK:
+         if (e->val.boolconstE==sense) code_goto(label);
+         break;
+    case eqK:
+         codeEQUALITY(e->val.eqE.left,e->val.eqE.right,label,sense);
+         break;
+    case neqK:
+         codeEQUALITY(e->val.neqE.left,e->val.neqE.right,label,!sense);
+         break;
+    case ltK:
+         codeCOMPARISON(ltK,e->val.ltE.left,e->val.ltE.right,label,sense);
+         break;
+    case gtK:
+         codeCOMPARISON(gtK,e->val.gtE.left,e->val.gtE.right,label,sense);
+         break;
+    case leqK:
+         codeCOMPARISON(leqK,e->val.leqE.left,e->val.leqE.right,label,sense);
+         break;
+    case geqK:
+         codeCOMPARISON(geqK,e->val.geqE.left,e->val.geqE.right,label,sense);
+         break;
+    default:
+         codeEXP(e);
+         if (sense) code_ifne(label); else code_ifeq(label);
+         break;
+  }
+}
+
+/* returns 1 if e is the constant null, 0 or false */
+int codeIsZero(EXP *e)
+{ switch (e->kind) {
+    case nullK:
+         return 1;
+    case intconstK:
+         return e->val.intconstE==0;
+    case boolconstK:
+         return e->val.boolconstE==0;
+    case charconstK:
+         return e->val.charconstE==0;
+    default:
+         return 0;
+  }
+}
+
+/* Jumps to label if the outcome of left==right is sense.  A comparison
+ * with null or zero tests the other operand directly.
+ */
+void codeEQUALITY(EXP *left, EXP *right, int label, int sense)
+{ int ref;
+  EXP *e;
+  ref = left->type->kind==refK || left->type->kind==polynullK;
+  if (codeIsZero(left) || codeIsZero(right)) {
+     e = codeIsZero(right) ? left : right;
+     codeEXP(e);
+     if (ref) {
+        if (sense) code_ifnull(label); else code_ifnonnull(label);
+     } else {
+        if (sense) code_ifeq(label); else code_ifne(label);
+     }
+  } else {
+     codeEXP(left);
+     codeEXP(right);
+     if (ref) {
+        if (sense) code_if_acmpeq(label); else code_if_acmpne(label);
+     } else {
+        if (sense) code_if_icmpeq(label); else code_if_icmpne(label);
+     }
+  }
+}
+
+/* Jumps to label if the outcome of the comparison kind of left and right
+ * is sense.  A comparison with zero tests the other operand directly.
+ */
+void codeCOMPARISON(int kind, EXP *left, EXP *right, int label, int sense)
+{ EXP *e;
+  if (!sense) {
+     switch (kind) {
+       case ltK: kind = geqK; break;
+       case gtK: kind = leqK; break;
+       case leqK: kind = gtK; break;
+       case geqK: kind = ltK; break;
+     }
+  }
+  if (codeIsZero(right) || codeIsZero(left)) {
+     /* 0<x is x>0 */
+     if (codeIsZero(right)) {
+        e = left;
+     } else {
+        e = right;
+        switch (kind) {
+          case ltK: kind = gtK; break;
+          case gtK: kind = ltK; break;
+          case leqK: kind = geqK; break;
+          case geqK: kind = leqK; break;
+        }
+     }
+     codeEXP(e);
+     switch (kind) {
+       case ltK: code_iflt(label); break;
+       case gtK: code_ifgt(label); break;
+       case leqK: code_ifle(label); break;
+       case geqK: code_ifge(label); break;
+     }
+  } else {
+     codeEXP(left);
+     codeEXP(right);
+     switch (kind) {
+       case ltK: code_if_icmplt(label); break;
+       case gtK: code_if_icmpgt(label); break;
+       case leqK: code_if_icmple(label); break;
+       case geqK: code_if_icmpge(label); break;
+     }
+  }
+}
+
+/* the number of operands of a left-nested string concatenation */
+int codeOperands(EXP *e)
+{ if (e->kind==plusK && e->type->kind!=intK) {
+     return codeOperands(e->val.plusE.left)+1;
+  }
+  return 1;
+}
+
+/* Pushes a StringBuffer holding every operand of a left-nested string
+ * concatenation.  The inner concatenations never yield null, so they need
+ * no conversion of their own.  A leading string constant goes straight to
+ * the constructor, which would throw on null.
+ */
+void codeCONCAT(EXP *e)
+{ if (e->kind==plusK && e->type->kind!=intK) {
+     codeCONCAT(e->val.plusE.left);
+     codeAPPEND(e->val.plusE.right);
+  } else {
+     code_new("java/lang/StringBuffer");
+     code_dup();
+     if (e->kind==stringconstK) {
+        code_ldc_string(e->val.stringconstE);
+        code_invokenonvirtual("java/lang/StringBuffer/<init>(Ljava/lang/String;)V");
+     } else {
+        code_invokenonvirtual("java/lang/StringBuffer/<init>()V");
+        codeAPPEND(e);
+     }
+  }
+}
+
+/* StringBuffer.append converts its argument exactly as the tostring code
+ * in codeEXP does, including "null" for null references, so the operand is
+ * pushed as it is.
+ */
+void codeAPPEND(EXP *e)
+{ int tostring;
+  tostring = e->tostring;
+  e->tostring = 0;
+  codeEXP(e);
+  e->tostring = tostring;
+  switch (e->type->kind) {
+    case intK:
+         code_invokevirtual("java/lang/StringBuffer/append(I)Ljava/lang/StringBuffer;");
+         break;
+    case boolK:
+         code_invokevirtual("java/lang/StringBuffer/append(Z)Ljava/lang/StringBuffer;");
+         break;
+    case charK:
+         code_invokevirtual("java/lang/StringBuffer/append(C)Ljava/lang/StringBuffer;");
+         break;
+    case refK:
+         if (strcmp(e->type->name,"String")==0) {
+            code_invokevirtual("java/lang/StringBuffer/append(Ljava/lang/String;)Ljava/lang/StringBuffer;");
+         } else {
+            code_invokevirtual("java/lang/StringBuffer/append(Ljava/lang/Object;)Ljava/lang/StringBuffer;");
+         }
+         break;
+    case polynullK:
+         code_invokevirtual("java/lang/StringBuffer/append(Ljava/lang/String;)Ljava/lang/StringBuffer;");
+         break;
+    case voidK:
+         break;
+  }
+}
+
 void codeRECEIVER(RECEIVER *r)
 { switch(r->kind) {
     case objectK:
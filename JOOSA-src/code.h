@@ -19,5 +19,12 @@ void codeCONSTRUCTOR(CONSTRUCTOR *c);
 void codeMETHOD(METHOD *m);
 void codeSTATEMENT(STATEMENT *s);
 void codeEXP(EXP *e);
+void codeCOND(EXP *e, int label, int sense);
+int codeIsZero(EXP *e);
+void codeEQUALITY(EXP *left, EXP *right, int label, int sense);
+void codeCOMPARISON(int kind, EXP *left, EXP *right, int label, int sense);
+int codeOperands(EXP *e);
+void codeCONCAT(EXP *e);
+void codeAPPEND(EXP *e);
 void codeRECEIVER(RECEIVER *r);
 void codeARGUMENT(ARGUMENT *a);
@@ -0,0 +1,177 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "codeinfo.h"
+
+CODEINFO codeinfo[] = {
+#define CODEKIND(name,flags,operand,pops,pushes,size) \
+  {name##CK,#name,flags,operand,pops,pushes,size},
+#include "codekind.h"
+#undef CODEKIND
+};
+
+int argSize(char *sig)
+{ int i,a;
+  i = a = 0;
+  while (sig[i]!='(') i++;
+  i++;
+  while (sig[i]!=')') {
+    a++;
+    while (sig[i]=='[') i++;
+    if (sig[i]=='L') {
+       while (sig[i]!=';') i++;
+    }
+    i++;
+  }
+  return a;
+}
+
+int resSize(char *sig)
+{ return sig[strlen(sig)-1]!='V';
+}
+
+/* The locals that hold the arguments on entry to a method with signature
+ * sig, with local 0 holding this or, in the one static method main, the
+ * String[] that sig leaves out.
+ */
+int entrySize(char *sig)
+{ return 1+argSize(sig);
+}
+
+int codeinfoPops(CODE *c)
+{ if (codeinfo[c->kind].pops!=CIVARIABLE) return codeinfo[c->kind].pops;
+  return 1+argSize(codeinfoString(c));
+}
+
+int codeinfoPushes(CODE *c)
+{ if (codeinfo[c->kind].pushes!=CIVARIABLE) return codeinfo[c->kind].pushes;
+  return resSize(codeinfoString(c));
+}
+
+int codeinfoSize(CODE *c)
+{ int i;
+  if (codeinfo[c->kind].size!=CIVARIABLE) return codeinfo[c->kind].size;
+  switch (codeinfo[c->kind].operand) {
+    case CISWITCH:
+         /* the padding to a multiple of 4 is counted as its worst case */
+         i = codeinfoSwitch(c)->count;
+         return c->kind==tableswitchCK ? 16+4*i : 12+8*i;
+    case CILOCAL:
+         i = codeinfoInt(c);
+         return i<4 ? 1 : i<256 ? 2 : 4;
+    case CIIINC:
+         return c->val.iincC.offset<256 && c->val.iincC.amount>=-128 &&
+                c->val.iincC.amount<=127 ? 3 : 6;
+    default:
+         i = codeinfoInt(c);
+         return i>=0 && i<=5 ? 1 : 2;
+  }
+}
+
+/* the operand of a CILOCAL, CILABEL or CIINT kind */
+int codeinfoInt(CODE *c)
+{ switch (c->kind) {
+    case labelCK: return c->val.labelC;
+    case gotoCK: return c->val.gotoC;
+    case ifeqCK: return c->val.ifeqC;
+    case ifneCK: return c->val.ifneC;
+    case ifltCK: return c->val.ifltC;
+    case ifgeCK: return c->val.ifgeC;
+    case ifgtCK: return c->val.ifgtC;
+    case ifleCK: return c->val.ifleC;
+    case if_acmpeqCK: return c->val.if_acmpeqC;
+    case if_acmpneCK: return c->val.if_acmpneC;
+    case ifnullCK: return c->val.ifnullC;
+    case ifnonnullCK: return c->val.ifnonnullC;
+    case if_icmpeqCK: return c->val.if_icmpeqC;
+    case if_icmpgtCK: return c->val.if_icmpgtC;
+    case if_icmpltCK: return c->val.if_icmpltC;
+    case if_icmpleCK: return c->val.if_icmpleC;
+    case if_icmpgeCK: return c->val.if_icmpgeC;
+    case if_icmpneCK: return c->val.if_icmpneC;
+    case aloadCK: return c->val.aloadC;
+    case astoreCK: return c->val.astoreC;
+    case iloadCK: return c->val.iloadC;
+    case istoreCK: return c->val.istoreC;
+    case ldc_intCK: return c->val.ldc_intC;
+    default: return 0;
+  }
+}
+
+void codeinfoSetInt(CODE *c, int i)
+{ switch (c->kind) {
+    case labelCK: c->val.labelC = i; break;
+    case gotoCK: c->val.gotoC = i; break;
+    case ifeqCK: c->val.ifeqC = i; break;
+    case ifneCK: c->val.ifneC = i; break;
+    case ifltCK: c->val.ifltC = i; break;
+    case ifgeCK: c->val.ifgeC = i; break;
+    case ifgtCK: c->val.ifgtC = i; break;
+    case ifleCK: c->val.ifleC = i; break;
+    case if_acmpeqCK: c->val.if_acmpeqC = i; break;
+    case if_acmpneCK: c->val.if_acmpneC = i; break;
+    case ifnullCK: c->val.ifnullC = i; break;
+    case ifnonnullCK: c->val.ifnonnullC = i; break;
+    case if_icmpeqCK: c->val.if_icmpeqC = i; break;
+    case if_icmpgtCK: c->val.if_icmpgtC = i; break;
+    case if_icmpltCK: c->val.if_icmpltC = i; break;
+    case if_icmpleCK: c->val.if_icmpleC = i; break;
+    case if_icmpgeCK: c->val.if_icmpgeC = i; break;
+    case if_icmpneCK: c->val.if_icmpneC = i; break;
+    case aloadCK: c->val.aloadC = i; break;
+    case astoreCK: c->val.astoreC = i; break;
+    case iloadCK: c->val.iloadC = i; break;
+    case istoreCK: c->val.istoreC = i; break;
+    case ldc_intCK: c->val.ldc_intC = i; break;
+    default: break;
+  }
+}
+
+/* the operand of a CISTRING kind */
+char *codeinfoString(CODE *c)
+{ switch (c->kind) {
+    case newCK: return c->val.newC;
+    case instanceofCK: return c->val.instanceofC;
+    case checkcastCK: return c->val.checkcastC;
+    case ldc_stringCK: return c->val.ldc_stringC;
+    case getfieldCK: return c->val.getfieldC;
+    case putfieldCK: return c->val.putfieldC;
+    case invokevirtualCK: return c->val.invokevirtualC;
+    case invokenonvirtualCK: return c->val.invokenonvirtualC;
+    default: return "";
+  }
+}
+
+void codeinfoSetString(CODE *c, char *s)
+{ switch (c->kind) {
+    case newCK: c->val.newC = s; break;
+    case instanceofCK: c->val.instanceofC = s; break;
+    case checkcastCK: c->val.checkcastC = s; break;
+    case ldc_stringCK: c->val.ldc_stringC = s; break;
+    case getfieldCK: c->val.getfieldC = s; break;
+    case putfieldCK: c->val.putfieldC = s; break;
+    case invokevirtualCK: c->val.invokevirtualC = s; break;
+    case invokenonvirtualCK: c->val.invokenonvirtualC = s; break;
+    default: break;
+  }
+}
+
+/* the cases of a CISWITCH kind */
+SWITCH *codeinfoSwitch(CODE *c)
+{ switch (c->kind) {
+    case tableswitchCK: return c->val.tableswitchC;
+    case lookupswitchCK: return c->val.lookupswitchC;
+    default: return NULL;
+  }
+}
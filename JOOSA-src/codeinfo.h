@@ -0,0 +1,65 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* The properties of every CODE kind, in one table indexed by kind.  Both
+ * the table and the enum of tree.h are generated from the rows of
+ * codekind.h, so they cannot get out of step.
+ */
+
+#define CODEKINDS lastCK
+
+/* flags */
+#define CIBRANCH 1        /* may jump to its label operand */
+#define CICONDITIONAL 2   /* may also fall through */
+#define CITERMINATOR 4    /* never falls through */
+#define CILOAD 8          /* reads its local */
+#define CISTORE 16        /* writes its local */
+#define CIPURE 32         /* cannot throw, touches no heap and calls nothing */
+#define CIPUSH 64         /* pushes one value without reading the stack */
+#define CIKEEPS 128       /* leaves the values it reads on the stack */
+
+/* operands */
+#define CINONE 0
+#define CILOCAL 1
+#define CIIINC 2
+#define CILABEL 3
+#define CIINT 4
+#define CISTRING 5
+#define CISWITCH 6
+
+/* for pops, pushes and size that depend on the operand */
+#define CIVARIABLE -1
+
+typedef struct CODEINFO {
+  int kind;
+  char *name;
+  int flags;
+  int operand;
+  int pops, pushes;
+  int size;               /* in bytes, as Jasmin encodes it */
+} CODEINFO;
+
+extern CODEINFO codeinfo[];
+
+int argSize(char *sig);
+int resSize(char *sig);
+int entrySize(char *sig);
+int codeinfoPops(CODE *c);
+int codeinfoPushes(CODE *c);
+int codeinfoSize(CODE *c);
+int codeinfoInt(CODE *c);
+void codeinfoSetInt(CODE *c, int i);
+char *codeinfoString(CODE *c);
+void codeinfoSetString(CODE *c, char *s);
+SWITCH *codeinfoSwitch(CODE *c);
@@ -0,0 +1,71 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+/* The CODE kinds and their properties, one row per kind in the order of the
+ * enum in tree.h.  This file has no include guard: tree.h includes it to
+ * declare the kinds and codeinfo.c to build the codeinfo table, each with
+ * its own definition of
+ *
+ *   CODEKIND(name, flags, operand, pops, pushes, size)
+ *
+ * so a new kind is added here and nowhere else.
+ */
+
+CODEKIND(nop,CIPURE,CINONE,0,0,1)
+CODEKIND(i2c,CIPURE,CINONE,1,1,1)
+CODEKIND(new,0,CISTRING,0,1,3)
+CODEKIND(instanceof,0,CISTRING,1,1,3)
+CODEKIND(checkcast,CIKEEPS,CISTRING,1,1,3)
+CODEKIND(imul,CIPURE,CINONE,2,1,1)
+CODEKIND(ineg,CIPURE,CINONE,1,1,1)
+CODEKIND(irem,0,CINONE,2,1,1)
+CODEKIND(isub,CIPURE,CINONE,2,1,1)
+CODEKIND(idiv,0,CINONE,2,1,1)
+CODEKIND(iadd,CIPURE,CINONE,2,1,1)
+CODEKIND(iinc,CIPURE|CILOAD|CISTORE,CIIINC,0,0,CIVARIABLE)
+CODEKIND(label,0,CILABEL,0,0,0)
+CODEKIND(goto,CIBRANCH|CITERMINATOR,CILABEL,0,0,3)
+CODEKIND(ifeq,CIBRANCH|CICONDITIONAL,CILABEL,1,0,3)
+CODEKIND(ifne,CIBRANCH|CICONDITIONAL,CILABEL,1,0,3)
+CODEKIND(iflt,CIBRANCH|CICONDITIONAL,CILABEL,1,0,3)
+CODEKIND(ifge,CIBRANCH|CICONDITIONAL,CILABEL,1,0,3)
+CODEKIND(ifgt,CIBRANCH|CICONDITIONAL,CILABEL,1,0,3)
+CODEKIND(ifle,CIBRANCH|CICONDITIONAL,CILABEL,1,0,3)
+CODEKIND(if_acmpeq,CIBRANCH|CICONDITIONAL,CILABEL,2,0,3)
+CODEKIND(if_acmpne,CIBRANCH|CICONDITIONAL,CILABEL,2,0,3)
+CODEKIND(ifnull,CIBRANCH|CICONDITIONAL,CILABEL,1,0,3)
+CODEKIND(ifnonnull,CIBRANCH|CICONDITIONAL,CILABEL,1,0,3)
+CODEKIND(if_icmpeq,CIBRANCH|CICONDITIONAL,CILABEL,2,0,3)
+CODEKIND(if_icmpgt,CIBRANCH|CICONDITIONAL,CILABEL,2,0,3)
+CODEKIND(if_icmplt,CIBRANCH|CICONDITIONAL,CILABEL,2,0,3)
+CODEKIND(if_icmple,CIBRANCH|CICONDITIONAL,CILABEL,2,0,3)
+CODEKIND(if_icmpge,CIBRANCH|CICONDITIONAL,CILABEL,2,0,3)
+CODEKIND(if_icmpne,CIBRANCH|CICONDITIONAL,CILABEL,2,0,3)
+CODEKIND(ireturn,CITERMINATOR,CINONE,1,0,1)
+CODEKIND(areturn,CITERMINATOR,CINONE,1,0,1)
+CODEKIND(return,CITERMINATOR,CINONE,0,0,1)
+CODEKIND(aload,CIPURE|CILOAD|CIPUSH,CILOCAL,0,1,CIVARIABLE)
+CODEKIND(astore,CIPURE|CISTORE,CILOCAL,1,0,CIVARIABLE)
+CODEKIND(iload,CIPURE|CILOAD|CIPUSH,CILOCAL,0,1,CIVARIABLE)
+CODEKIND(istore,CIPURE|CISTORE,CILOCAL,1,0,CIVARIABLE)
+CODEKIND(dup,CIPURE|CIKEEPS,CINONE,1,2,1)
+CODEKIND(pop,CIPURE,CINONE,1,0,1)
+CODEKIND(swap,CIPURE,CINONE,2,2,1)
+CODEKIND(ldc_int,CIPURE|CIPUSH,CIINT,0,1,CIVARIABLE)
+CODEKIND(ldc_string,CIPURE|CIPUSH,CISTRING,0,1,2)
+CODEKIND(aconst_null,CIPURE|CIPUSH,CINONE,0,1,1)
+CODEKIND(getfield,0,CISTRING,1,1,3)
+CODEKIND(putfield,0,CISTRING,2,0,3)
+CODEKIND(invokevirtual,0,CISTRING,CIVARIABLE,CIVARIABLE,3)
+CODEKIND(invokenonvirtual,0,CISTRING,CIVARIABLE,CIVARIABLE,3)
+CODEKIND(tableswitch,CITERMINATOR,CISWITCH,1,0,CIVARIABLE)
+CODEKIND(lookupswitch,CITERMINATOR,CISWITCH,1,0,CIVARIABLE)
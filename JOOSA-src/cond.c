@@ -0,0 +1,230 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include "memory.h"
+#include "flow.h"
+#include "codeinfo.h"
+#include "optimize.h"
+#include "cond.h"
+
+int condfolded;
+
+/* The operands of a test, ordered so that a is a local and, when both are
+ * locals, a<b.  b is -1 for a constant c; tests against zero or null use
+ * the constant 0.  The outcome is a mask of the relations a<b, a==b and
+ * a>b under which the test is taken.
+ */
+typedef struct CONDKEY {
+  int a, b, c, isref;
+} CONDKEY;
+
+#define LT 1
+#define EQ 2
+#define GT 4
+#define ALL (LT|EQ|GT)
+
+int condMask(int kind)
+{ switch (kind) {
+    case ifeqCK:
+    case ifnullCK:
+    case if_icmpeqCK:
+    case if_acmpeqCK:
+         return EQ;
+    case ifneCK:
+    case ifnonnullCK:
+    case if_icmpneCK:
+    case if_acmpneCK:
+         return LT|GT;
+    case ifltCK:
+    case if_icmpltCK:
+         return LT;
+    case ifgeCK:
+    case if_icmpgeCK:
+         return EQ|GT;
+    case ifgtCK:
+    case if_icmpgtCK:
+         return GT;
+    case ifleCK:
+    case if_icmpleCK:
+         return LT|EQ;
+    default:
+         return 0;
+  }
+}
+
+/* the mask of the same test with its operands swapped */
+int condMirror(int mask)
+{ return (mask&EQ) | (mask&LT ? GT : 0) | (mask&GT ? LT : 0);
+}
+
+/* 1 if code[j] pushes a local, setting *k, 0 if it pushes a constant,
+ * setting *c, and -1 otherwise
+ */
+int condOperand(FLOW *f, int j, int *k, int *c)
+{ if (j<0) return -1;
+  switch (f->code[j]->kind) {
+    case iloadCK:
+    case aloadCK:
+         *k = codeinfoInt(f->code[j]);
+         return 1;
+    case ldc_intCK:
+         *c = f->code[j]->val.ldc_intC;
+         return 0;
+    case aconst_nullCK:
+         *c = 0;
+         return 0;
+    default:
+         return -1;
+  }
+}
+
+/* recognizes the test code[i] with its operands loaded just before it */
+int condTest(FLOW *f, int i, CONDKEY *key, int *mask)
+{ CODE *g;
+  int x, y, kx, ky, cx, cy, t;
+  g = f->code[i];
+  *mask = condMask(g->kind);
+  if (*mask==0 || f->height[i]==-1) return 0;
+  key->isref = g->kind==ifnullCK || g->kind==ifnonnullCK ||
+               g->kind==if_acmpeqCK || g->kind==if_acmpneCK;
+  if (codeinfoPops(g)==1) {
+     if (condOperand(f,i-1,&key->a,&cx)!=1) return 0;
+     key->b = -1;
+     key->c = 0;
+     return 1;
+  }
+  x = condOperand(f,i-2,&kx,&cx);
+  y = condOperand(f,i-1,&ky,&cy);
+  if (x==-1 || y==-1 || (x==0 && y==0)) return 0;
+  if (x==0 || (y==1 && ky<kx)) {
+     t = kx; kx = ky; ky = t;
+     t = cx; cx = cy; cy = t;
+     t = x; x = y; y = t;
+     *mask = condMirror(*mask);
+  }
+  if (y==1 && kx==ky) return 0;
+  key->a = kx;
+  key->b = y==1 ? ky : -1;
+  key->c = y==1 ? 0 : cy;
+  return 1;
+}
+
+int condSame(CONDKEY *x, CONDKEY *y)
+{ return x->a==y->a && x->b==y->b && x->c==y->c && x->isref==y->isref;
+}
+
+/* 1 if c assigns local k */
+int condKills(CODE *c, int k)
+{ switch (c->kind) {
+    case istoreCK:
+    case astoreCK:
+         return codeinfoInt(c)==k;
+    case iincCK:
+         return c->val.iincC.offset==k;
+    default:
+         return 0;
+  }
+}
+
+/* An edge out of a test establishes its outcome at the start of its
+ * target when it is the only way in, and the outcome then holds wherever
+ * that start dominates, until a or b is assigned.  This is exactly where
+ * the outcome is available on every path when it is generated at such
+ * starts only, so flowAvailable does the work of the dominator tree.
+ * decided[j] gets the outcome of each test j that the edges with outcomes
+ * within mask decide.
+ */
+void condFacts(FLOW *f, CONDKEY *keys, int *masks, int *preds, int first,
+               int mask, char *kill, int *decided)
+{ char *gen, *avail;
+  int j, s;
+  gen = Malloc(f->count+1);
+  for (j=0; j<f->count; j++) gen[j] = 0;
+  for (j=first; j<f->count; j++) {
+      if (masks[j]==0 || !condSame(&keys[j],&keys[first])) continue;
+      s = f->target[j];
+      if (s!=j+1 && preds[s]==1 && (masks[j]&~mask)==0 && !kill[s]) {
+         gen[s] = 1;
+      }
+      s = j+1;
+      if (s<f->count && f->target[j]!=s && preds[s]==1 &&
+          ((ALL&~masks[j])&~mask)==0 && !kill[s]) {
+         gen[s] = 1;
+      }
+  }
+  avail = flowAvailable(f,gen,kill);
+  for (j=first; j<f->count; j++) {
+      if (masks[j]==0 || !condSame(&keys[j],&keys[first]) || !avail[j]) continue;
+      if ((mask&~masks[j])==0) decided[j] = 1;
+      else if ((mask&masks[j])==0) decided[j] = 0;
+  }
+}
+
+int condCODE(CODE *c, int localslimit)
+{ FLOW *f;
+  CONDKEY *keys;
+  CODE *g, *r;
+  char *kill;
+  int *masks, *preds, *decided, succ[2];
+  int i, j, k, n, change;
+
+  f = flowCODE(c,localslimit);
+  keys = Malloc((f->count+1)*sizeof(CONDKEY));
+  masks = Malloc((f->count+1)*sizeof(int));
+  preds = Malloc((f->count+1)*sizeof(int));
+  decided = Malloc((f->count+1)*sizeof(int));
+  kill = Malloc(f->count+1);
+  for (i=0; i<f->count; i++) {
+      if (!condTest(f,i,&keys[i],&masks[i])) masks[i] = 0;
+      preds[i] = i==0;
+      decided[i] = -1;
+  }
+  for (i=0; i<f->count; i++) {
+      if (f->height[i]==-1) continue;
+      n = flowSuccessors(f,i,succ);
+      for (j=0; j<n; j++) preds[succ[j]]++;
+  }
+
+  for (i=0; i<f->count; i++) {
+      if (masks[i]==0) continue;
+      /* each pair of operands is tried at its first test only */
+      for (j=0; j<i && (masks[j]==0 || !condSame(&keys[j],&keys[i])); j++);
+      if (j<i) continue;
+      for (j=0; j<f->count; j++) {
+          kill[j] = condKills(f->code[j],keys[i].a) ||
+                    (keys[i].b!=-1 && condKills(f->code[j],keys[i].b));
+      }
+      for (j=i; j<f->count; j++) {
+          if (masks[j]==0 || !condSame(&keys[j],&keys[i])) continue;
+          condFacts(f,keys,masks,preds,i,masks[j],kill,decided);
+          condFacts(f,keys,masks,preds,i,ALL&~masks[j],kill,decided);
+      }
+  }
+
+  change = 0;
+  for (i=0; i<f->count; i++) {
+      if (decided[i]==-1) continue;
+      g = f->code[i];
+      if (decided[i]) {
+         r = makeCODEgoto(codeinfoInt(g),g->next);
+      } else {
+         droplabel(codeinfoInt(g));
+         r = g->next;
+      }
+      for (k=codeinfoPops(g); k>0; k--) r = makeCODEpop(r);
+      *g = *r;
+      condfolded++;
+      change = 1;
+  }
+  return change;
+}
@@ -0,0 +1,23 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Redundant condition elimination: a test of locals, or of a local and a
+ * constant, whose outcome follows from a test of the same operands that
+ * dominates it, with neither local assigned in between, is replaced by
+ * pops and, if taken, a goto.
+ */
+
+extern int condfolded;
+
+int condCODE(CODE *c, int localslimit);
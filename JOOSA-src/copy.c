@@ -0,0 +1,202 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include "memory.h"
+#include "codeinfo.h"
+#include "flow.h"
+#include "copy.h"
+
+int copiesremoved;
+
+/* returns the local that c loads from, stores to or increments, or -1 */
+int copyLocal(CODE *c)
+{ switch (c->kind) {
+    case iloadCK:
+         return c->val.iloadC;
+    case aloadCK:
+         return c->val.aloadC;
+    case istoreCK:
+         return c->val.istoreC;
+    case astoreCK:
+         return c->val.astoreC;
+    case iincCK:
+         return c->val.iincC.offset;
+    default:
+         return -1;
+  }
+}
+
+int copyIsLoad(CODE *c)
+{ return c->kind==iloadCK || c->kind==aloadCK;
+}
+
+int copySize(int k)
+{ return k<4 ? 1 : k<256 ? 2 : 4;
+}
+
+int copySkip(FLOW *f, int i)
+{ while (i>=0 && f->code[i]->kind==nopCK) i--;
+  return i;
+}
+
+/* If code[s] stores a copy of another local, sets *a to it and returns the
+ * index of the instruction that feeds the store: the load in
+ * "xload a; xstore b", or the dup in "xload a; dup; xstore b" and
+ * "xload a; dup; xstore c; xstore b".  Returns -1 otherwise.
+ */
+int copyFeed(FLOW *f, int s, int *a)
+{ int i, j;
+  CODE *c;
+  c = f->code[s];
+  if (f->height[s]==-1 || (c->kind!=istoreCK && c->kind!=astoreCK)) return -1;
+  i = copySkip(f,s-1);
+  if (i>=0 && f->code[i]->kind==c->kind) i = copySkip(f,i-1);
+  if (i<0) return -1;
+  j = f->code[i]->kind==dupCK ? copySkip(f,i-1) : i;
+  if (j<0 || f->code[j]->kind!=(c->kind==istoreCK ? iloadCK : aloadCK)) {
+     return -1;
+  }
+  if (j==i && i!=copySkip(f,s-1)) return -1;
+  *a = copyLocal(f->code[j]);
+  return *a==copyLocal(c) ? -1 : i;
+}
+
+int copyIsCopy(FLOW *f, int s, int a, int b)
+{ int source;
+  return copyLocal(f->code[s])==b && copyFeed(f,s,&source)!=-1 && source==a;
+}
+
+/* Propagates the copies of a into b.  The copy is available after each
+ * store of a copy of a into b until a store or iinc to either local; a load
+ * of b where it is available on every path reads a instead.  The copies
+ * that leave b dead are then deleted, and nothing is done unless the code
+ * gets smaller.
+ */
+int copyPair(FLOW *f, int a, int b)
+{ char *gen, *kill, *avail, *use, *def, *live;
+  int i, x, feed, rewrites, removed, saved;
+
+  gen = Malloc(f->count+1);
+  kill = Malloc(f->count+1);
+  for (i=0; i<f->count; i++) {
+      x = copyLocal(f->code[i]);
+      gen[i] = copyIsCopy(f,i,a,b);
+      kill[i] = (x==a || x==b) && !copyIsLoad(f->code[i]);
+  }
+  avail = flowAvailable(f,gen,kill);
+
+  /* the loads of b left after rewriting are the only readers of b */
+  use = Malloc(f->count+1);
+  def = Malloc(f->count+1);
+  rewrites = 0;
+  for (i=0; i<f->count; i++) {
+      use[i] = def[i] = 0;
+      if (f->height[i]==-1 || copyLocal(f->code[i])!=b) continue;
+      if (copyIsLoad(f->code[i]) && avail[i]) {
+         rewrites++;
+      } else if (copyIsLoad(f->code[i]) || f->code[i]->kind==iincCK) {
+         use[i] = 1;
+      } else {
+         def[i] = 1;
+      }
+  }
+  live = flowLive(f,use,def);
+
+  removed = 0;
+  saved = rewrites*(copySize(b)-copySize(a));
+  for (i=0; i<f->count; i++) {
+      if (!gen[i] || live[i]) continue;
+      removed++;
+      feed = copyFeed(f,i,&x);
+      saved += copySize(b) + (f->code[feed]->kind==dupCK ? 1 : copySize(a));
+  }
+  if (saved<=0) return 0;
+
+  for (i=0; i<f->count; i++) {
+      if (copyLocal(f->code[i])==b && copyIsLoad(f->code[i]) && avail[i]) {
+         codeinfoSetInt(f->code[i],a);
+      }
+  }
+  /* each feed is looked up again, as deleting a copy can change the form
+   * of the next one */
+  for (i=0; i<f->count; i++) {
+      if (!gen[i] || live[i]) continue;
+      f->code[copyFeed(f,i,&x)]->kind = nopCK;
+      f->code[i]->kind = nopCK;
+  }
+  copiesremoved += removed;
+  return 1;
+}
+
+/* Renumbers the locals above this and the arguments so that the most used
+ * ones get the lowest slots and unused slots disappear.  The arguments are
+ * counted from signature, as main has no FORMAL for its String[].
+ */
+int copyRenumber(CODE *c, char *signature, int *localslimit)
+{ int *uses, *slot, *order;
+  int i, j, k, pinned, limit, change;
+  CODE *d;
+  pinned = entrySize(signature);
+  uses = Malloc((*localslimit+1)*sizeof(int));
+  slot = Malloc((*localslimit+1)*sizeof(int));
+  order = Malloc((*localslimit+1)*sizeof(int));
+  for (k=0; k<*localslimit; k++) uses[k] = 0;
+  for (d=c; d!=NULL; d=d->next) {
+      k = copyLocal(d);
+      if (k>=0) uses[k]++;
+  }
+  /* insertion sort by decreasing use, ties kept in slot order */
+  limit = 0;
+  for (k=pinned; k<*localslimit; k++) {
+      if (uses[k]==0) continue;
+      for (j=limit; j>0 && uses[order[j-1]]<uses[k]; j--) order[j] = order[j-1];
+      order[j] = k;
+      limit++;
+  }
+  change = 0;
+  for (k=0; k<pinned && k<*localslimit; k++) slot[k] = k;
+  for (i=0; i<limit; i++) {
+      slot[order[i]] = pinned+i;
+      if (order[i]!=pinned+i) change = 1;
+  }
+  if (pinned+limit<*localslimit) {
+     *localslimit = pinned+limit;
+     change = 1;
+  }
+  if (!change) return 0;
+  for (d=c; d!=NULL; d=d->next) {
+      k = copyLocal(d);
+      if (k<0) continue;
+      if (d->kind==iincCK) {
+         d->val.iincC.offset = slot[k];
+      } else {
+         codeinfoSetInt(d,slot[k]);
+      }
+  }
+  return 1;
+}
+
+int copyCODE(CODE *c, char *signature, int *localslimit)
+{ FLOW *f;
+  int i, j, a, b, change;
+  f = flowCODE(c,*localslimit);
+  change = 0;
+  for (i=0; i<f->count; i++) {
+      if (copyFeed(f,i,&a)==-1) continue;
+      b = copyLocal(f->code[i]);
+      /* each pair is tried at its first occurrence only */
+      for (j=0; j<i && !copyIsCopy(f,j,a,b); j++);
+      if (j==i && copyPair(f,a,b)) change = 1;
+  }
+  return copyRenumber(c,signature,localslimit) || change;
+}
@@ -0,0 +1,23 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Copy propagation: after "xload a; xstore b" the loads of b that only this
+ * kind of copy reaches read a instead, and copies nobody reads any more are
+ * deleted.  The locals are then renumbered so that the slots this frees
+ * are reused and the most used locals get the short load and store forms.
+ */
+
+extern int copiesremoved;
+
+int copyCODE(CODE *c, char *signature, int *localslimit);
@@ -14,6 +14,7 @@
 #include <string.h>
 #include "memory.h"
 #include "emit.h"
+#include "codeinfo.h"
 
 FILE *emitFILE;
 
@@ -43,25 +44,6 @@ void localmem(char *opcode, int offset)
   }
 }
 
-int argSize(char *sig)
-{ int i,a;
-  i = a = 0;
-  while (sig[i]!='(') i++;
-  i++;
-  while (sig[i]!=')') {
-    a++;
-    if (sig[i]=='L') {
-       while (sig[i]!=';') i++;
-    }
-    i++;
-  }
-  return a;
-}
-
-int resSize(char *sig)
-{ return sig[strlen(sig)-1]!='V';
-}
-
 int stacklimit;
 
 int setStack(int s)
@@ -70,153 +52,22 @@ int setStack(int s)
 }
 
 void simCODE(CODE *c, int baseheight)
-{ if (c!=NULL && !c->visited) {
+{ SWITCH *s;
+  int i;
+  if (c!=NULL && !c->visited) {
      c->visited = 1;
-     switch(c->kind) {
-       case nopCK:
-            baseheight = setStack(baseheight);
-            break;
-       case i2cCK:
-            baseheight = setStack(baseheight);
-            break;
-       case newCK:
-            baseheight = setStack(baseheight+1);
-            break;
-       case instanceofCK:
-            baseheight = setStack(baseheight);
-            break;
-       case checkcastCK:
-            baseheight = setStack(baseheight);
-            break;
-       case imulCK:
-            baseheight = setStack(baseheight-1);
-            break;
-       case inegCK:
-            baseheight = setStack(baseheight);
-            break;
-       case iremCK:
-            baseheight = setStack(baseheight-1);
-            break;
-       case isubCK:
-            baseheight = setStack(baseheight-1);
-            break;
-       case idivCK:
-            baseheight = setStack(baseheight-1);
-            break;
-       case iaddCK:
-            baseheight = setStack(baseheight-1);
-            break;
-       case iincCK:
-            baseheight = setStack(baseheight);
-            break;
-       case labelCK:
-            baseheight = setStack(baseheight);
-            break;
-       case gotoCK:
-            baseheight = setStack(baseheight);
-            simCODE(emitlabels[c->val.gotoC].position,baseheight);
-            break;
-       case ifeqCK:
-            baseheight = setStack(baseheight-1);
-            simCODE(emitlabels[c->val.ifeqC].position,baseheight);
-            break;
-       case ifneCK:
-            baseheight = setStack(baseheight-1);
-            simCODE(emitlabels[c->val.ifneC].position,baseheight);
-            break;
-       case if_acmpeqCK:
-            baseheight = setStack(baseheight-2);
-            simCODE(emitlabels[c->val.if_acmpeqC].position,baseheight);
-            break;
-       case if_acmpneCK:
-            baseheight = setStack(baseheight-2);
-            simCODE(emitlabels[c->val.if_acmpneC].position,baseheight);
-            break;
-       case ifnullCK:
-            baseheight = setStack(baseheight-1);
-            simCODE(emitlabels[c->val.ifnullC].position,baseheight);
-            break;
-       case ifnonnullCK:
-            baseheight = setStack(baseheight-1);
-            simCODE(emitlabels[c->val.ifnonnullC].position,baseheight);
-            break;
-       case if_icmpeqCK:
-            baseheight = setStack(baseheight-2);
-            simCODE(emitlabels[c->val.if_icmpeqC].position,baseheight);
-            break;
-       case if_icmpgtCK:
-            baseheight = setStack(baseheight-2);
-            simCODE(emitlabels[c->val.if_icmpgtC].position,baseheight);
-            break;
-       case if_icmpltCK:
-            baseheight = setStack(baseheight-2);
-            simCODE(emitlabels[c->val.if_icmpltC].position,baseheight);
-            break;
-       case if_icmpleCK:
-            baseheight = setStack(baseheight-2);
-            simCODE(emitlabels[c->val.if_icmpleC].position,baseheight);
-            break;
-       case if_icmpgeCK:
-            baseheight = setStack(baseheight-2);
-            simCODE(emitlabels[c->val.if_icmpgeC].position,baseheight);
-            break;
-       case if_icmpneCK:
-            baseheight = setStack(baseheight-2);
-            simCODE(emitlabels[c->val.if_icmpneC].position,baseheight);
-            break;
-       case ireturnCK:
-            baseheight = setStack(baseheight-1);
-            return;
-       case areturnCK:
-            baseheight = setStack(baseheight-1);
-            return;
-       case returnCK:
-            baseheight = setStack(baseheight);
-            return;
-       case aloadCK:
-            baseheight = setStack(baseheight+1);
-            break;
-       case astoreCK:
-            baseheight = setStack(baseheight-1);
-            break;
-       case iloadCK:
-            baseheight = setStack(baseheight+1);
-            break;
-       case istoreCK:
-            baseheight = setStack(baseheight-1);
-            break;
-       case dupCK:
-            baseheight = setStack(baseheight+1);
-            break;
-       case popCK:
-            baseheight = setStack(baseheight-1);
-            break;
-       case swapCK:
-            baseheight = setStack(baseheight);
-            break;
-       case ldc_intCK:
-            baseheight = setStack(baseheight+1);
-            break;
-       case ldc_stringCK:
-            baseheight = setStack(baseheight+1);
-            break;
-       case aconst_nullCK:
-            baseheight = setStack(baseheight+1);
-            break;
-       case getfieldCK:
-            baseheight = setStack(baseheight);
-            break;
-       case putfieldCK:
-            baseheight = setStack(baseheight-2);
-            break;
-       case invokevirtualCK:
-            baseheight = setStack(baseheight-1-argSize(c->val.invokevirtualC)
-                                                  +resSize(c->val.invokevirtualC));
-            break;
-       case invokenonvirtualCK:
-            baseheight = setStack(baseheight-1-argSize(c->val.invokenonvirtualC)
-                                                  +resSize(c->val.invokenonvirtualC));
-            break;
+     baseheight = setStack(baseheight-codeinfoPops(c)+codeinfoPushes(c));
+     if (codeinfo[c->kind].operand==CISWITCH) {
+        s = codeinfoSwitch(c);
+        for (i=0; i<s->count; i++) {
+            simCODE(emitlabels[s->labels[i]].position,baseheight);
+        }
+        simCODE(emitlabels[s->defaultlabel].position,baseheight);
+        return;
+     } else if (codeinfo[c->kind].flags&CIBRANCH) {
+        simCODE(emitlabels[codeinfoInt(c)].position,baseheight);
+     } else if (codeinfo[c->kind].flags&CITERMINATOR) {
+        return;
      }
      simCODE(c->next,baseheight);
   }
@@ -228,6 +79,17 @@ int limitCODE(CODE *c)
   return stacklimit;
 }
 
+void emitSWITCH(SWITCH *s, int table)
+{ int i;
+  for (i=0; i<s->count; i++) {
+      fprintf(emitFILE,"\n    ");
+      if (!table) fprintf(emitFILE,"%i : ",s->keys[i]);
+      emitLABEL(s->labels[i]);
+  }
+  fprintf(emitFILE,"\n    default : ");
+  emitLABEL(s->defaultlabel);
+}
+
 void emitCODE(CODE *c)
 { if (c!=NULL) {
      fprintf(emitFILE,"  ");
@@ -285,6 +147,22 @@ void emitCODE(CODE *c)
             fprintf(emitFILE,"ifne ");
             emitLABEL(c->val.ifneC);
             break;
+       case ifltCK:
+            fprintf(emitFILE,"iflt ");
+            emitLABEL(c->val.ifltC);
+            break;
+       case ifgeCK:
+            fprintf(emitFILE,"ifge ");
+            emitLABEL(c->val.ifgeC);
+            break;
+       case ifgtCK:
+            fprintf(emitFILE,"ifgt ");
+            emitLABEL(c->val.ifgtC);
+            break;
+       case ifleCK:
+            fprintf(emitFILE,"ifle ");
+            emitLABEL(c->val.ifleC);
+            break;
        case if_acmpeqCK:
             fprintf(emitFILE,"if_acmpeq ");
             emitLABEL(c->val.if_acmpeqC);
@@ -380,6 +258,17 @@ void emitCODE(CODE *c)
        case invokenonvirtualCK:
             fprintf(emitFILE,"invokenonvirtual %s",c->val.invokenonvirtualC);
             break;
+       case tableswitchCK:
+            fprintf(emitFILE,"tableswitch %i %i",c->val.tableswitchC->keys[0],
+                    c->val.tableswitchC->keys[c->val.tableswitchC->count-1]);
+            emitSWITCH(c->val.tableswitchC,1);
+            break;
+       case lookupswitchCK:
+            fprintf(emitFILE,"lookupswitch");
+            emitSWITCH(c->val.lookupswitchC,0);
+            break;
+       case lastCK: /* only counts the kinds */
+            break;
      }
      fprintf(emitFILE,"\n");
      emitCODE(c->next);
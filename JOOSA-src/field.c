@@ -0,0 +1,170 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "symbol.h"
+#include "cha.h"
+#include "optimize.h"
+#include "field.h"
+
+int fieldsremoved, fieldstores;
+
+/* the field that "Class/name type", the operand of a getfield or putfield,
+ * refers to, or NULL if it belongs to a library class
+ */
+FIELD *fieldLookup(char *access)
+{ char *space, *slash, *s;
+  CLASS *c, *owner;
+  SYMBOL *f;
+  space = strchr(access,' ');
+  if (space==NULL) return NULL;
+  for (slash=space; slash>access && *slash!='/'; slash--);
+  if (slash==access) return NULL;
+  s = Malloc(slash-access+1);
+  strncpy(s,access,slash-access);
+  s[slash-access] = '\0';
+  c = chaClass(s);
+  if (c==NULL) return NULL;
+  s = Malloc(space-slash);
+  strncpy(s,slash+1,space-slash-1);
+  s[space-slash-1] = '\0';
+  f = lookupHierarchy(s,c);
+  owner = lookupHierarchyClass(s,c);
+  if (f==NULL || f->kind!=fieldSym || owner==NULL || owner->external) {
+     return NULL;
+  }
+  return f->val.fieldS;
+}
+
+void fieldReadCODE(CODE *c)
+{ FIELD *f;
+  for (; c!=NULL; c=c->next) {
+      if (c->kind!=getfieldCK) continue;
+      f = fieldLookup(c->val.getfieldC);
+      if (f!=NULL) f->read = 1;
+  }
+}
+
+/* keeps the fields that c still stores to, which it does when
+ * -fopt-bisect-limit stopped fieldStoreCODE
+ */
+void fieldKeepCODE(CODE *c)
+{ FIELD *f;
+  for (; c!=NULL; c=c->next) {
+      if (c->kind!=putfieldCK) continue;
+      f = fieldLookup(c->val.putfieldC);
+      if (f!=NULL) f->read = 1;
+  }
+}
+
+/* 1 if c stores to a field that is never read */
+int fieldDeadStore(CODE *c)
+{ FIELD *f;
+  if (c==NULL || c->kind!=putfieldCK) return 0;
+  f = fieldLookup(c->val.putfieldC);
+  return f!=NULL && !f->read;
+}
+
+int fieldStoreCODE(CODE **c)
+{ int change;
+  change = 0;
+  for (; *c!=NULL; c=&(*c)->next) {
+      /* the code generator stores with aload_0 swap putfield */
+      if ((*c)->kind==aloadCK && (*c)->val.aloadC==0 &&
+          (*c)->next!=NULL && (*c)->next->kind==swapCK &&
+          fieldDeadStore((*c)->next->next)) {
+         *c = makeCODEpop((*c)->next->next->next);
+         fieldstores++;
+         change = 1;
+      } else if (fieldDeadStore(*c)) {
+         *c = makeCODEpop(makeCODEpop((*c)->next));
+         fieldstores++;
+         change = 1;
+      }
+  }
+  return change;
+}
+
+void fieldPROGRAM(PROGRAM *p)
+{ PROGRAM *q;
+  CLASSFILE *f;
+  CONSTRUCTOR *k;
+  METHOD *m;
+  FIELD **pd;
+
+  chaBuildPROGRAM(p);
+  fieldsremoved = fieldstores = 0;
+  for (q=p; q!=NULL; q=q->next) {
+      for (f=q->classfile; f!=NULL; f=f->next) {
+          if (f->class->external) continue;
+          for (k=f->class->constructors; k!=NULL; k=k->next) {
+              fieldReadCODE(k->opcodes);
+          }
+          for (m=f->class->methods; m!=NULL; m=m->next) {
+              fieldReadCODE(m->opcodes);
+          }
+      }
+  }
+
+  for (q=p; q!=NULL; q=q->next) {
+      for (f=q->classfile; f!=NULL; f=f->next) {
+          if (f->class->external) continue;
+          for (k=f->class->constructors; k!=NULL; k=k->next) {
+              optiName(f->class->name,"<init>");
+              if (optiAllowed() && fieldStoreCODE(&k->opcodes)) {
+                 optiRewrite("fieldStoreCODE",NULL);
+              }
+          }
+          for (m=f->class->methods; m!=NULL; m=m->next) {
+              optiName(f->class->name,m->name);
+              if (optiAllowed() && fieldStoreCODE(&m->opcodes)) {
+                 optiRewrite("fieldStoreCODE",NULL);
+              }
+          }
+      }
+  }
+
+  if (optilimit>=0) {
+     for (q=p; q!=NULL; q=q->next) {
+         for (f=q->classfile; f!=NULL; f=f->next) {
+             if (f->class->external) continue;
+             for (k=f->class->constructors; k!=NULL; k=k->next) {
+                 fieldKeepCODE(k->opcodes);
+             }
+             for (m=f->class->methods; m!=NULL; m=m->next) {
+                 fieldKeepCODE(m->opcodes);
+             }
+         }
+     }
+  }
+
+  for (q=p; q!=NULL; q=q->next) {
+      for (f=q->classfile; f!=NULL; f=f->next) {
+          if (f->class->external) continue;
+          for (pd=&f->class->fields; *pd!=NULL;) {
+              if ((*pd)->read || !optiAllowed()) {
+                 pd = &(*pd)->next;
+              } else {
+                 optiName(f->class->name,(*pd)->name);
+                 optiRewrite("fieldPROGRAM",NULL);
+                 *pd = (*pd)->next;
+                 fieldsremoved++;
+              }
+          }
+      }
+  }
+
+  printf("\nunread fields removed: %i, stores: %i\n",
+         fieldsremoved,fieldstores);
+}
@@ -0,0 +1,21 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Unread-field elimination.  A field of the program that no getfield in
+ * the whole program reads is removed, and every putfield to it becomes pops
+ * of its operands.  Fields are only ever accessed through this, so the
+ * putfield cannot throw and the stored value is still computed.
+ */
+
+void fieldPROGRAM(PROGRAM *p);
@@ -0,0 +1,284 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "optimize.h"
+#include "flow.h"
+#include "codeinfo.h"
+
+/* returns 0 if control never reaches the instruction following c */
+int flowFallsThrough(CODE *c)
+{ return !(codeinfo[c->kind].flags&CITERMINATOR);
+}
+
+int flowIndex(FLOW *f, CODE *c)
+{ int i;
+  for (i=0; i<f->count; i++) {
+      if (f->code[i]==c) return i;
+  }
+  return -1;
+}
+
+/* propagates the stack height h to instruction i */
+void flowHeight(FLOW *f, int i, int h, int *work, int *top)
+{ if (i<f->count && f->height[i]==-1) {
+     f->height[i] = h;
+     work[(*top)++] = i;
+  }
+}
+
+FLOW *flowCODE(CODE *c, int localslimit)
+{ FLOW *f;
+  CODE *p;
+  int i, l, inc, affected, used;
+  int *work, top;
+
+  f = NEW(FLOW);
+  f->count = 0;
+  f->labelcount = 0;
+  for (p=c; p!=NULL; p=p->next) {
+      f->count++;
+      if (p->kind==labelCK && p->val.labelC>=f->labelcount) {
+         f->labelcount = p->val.labelC+1;
+      }
+  }
+  f->code = Malloc((f->count+1)*sizeof(CODE *));
+  f->target = Malloc((f->count+1)*sizeof(int));
+  f->height = Malloc((f->count+1)*sizeof(int));
+  f->labelindex = Malloc((f->labelcount+1)*sizeof(int));
+  for (l=0; l<f->labelcount; l++) f->labelindex[l] = -1;
+  for (i=0, p=c; p!=NULL; i++, p=p->next) {
+      f->code[i] = p;
+      f->height[i] = -1;
+      if (p->kind==labelCK) f->labelindex[p->val.labelC] = i;
+  }
+  for (i=0; i<f->count; i++) {
+      if (uses_label(f->code[i],&l) && l<f->labelcount) {
+         f->target[i] = f->labelindex[l];
+      } else {
+         f->target[i] = -1;
+      }
+  }
+
+  /* stack heights, as simCODE computes them in emit.c */
+  f->stacklimit = 0;
+  work = Malloc((f->count+1)*sizeof(int));
+  top = 0;
+  flowHeight(f,0,0,work,&top);
+  while (top>0) {
+    i = work[--top];
+    stack_effect(f->code[i],&inc,&affected,&used);
+    if (f->height[i]>f->stacklimit) f->stacklimit = f->height[i];
+    if (f->height[i]+inc>f->stacklimit) f->stacklimit = f->height[i]+inc;
+    if (f->target[i]!=-1) flowHeight(f,f->target[i],f->height[i]+inc,work,&top);
+    if (flowFallsThrough(f->code[i])) flowHeight(f,i+1,f->height[i]+inc,work,&top);
+  }
+
+  f->localslimit = localslimit;
+  f->width = 1+f->stacklimit+f->localslimit;
+  f->state = NULL;
+  return f;
+}
+
+/* returns a fresh state with an empty stack and every local unknown */
+int *flowEntry(FLOW *f, int unknown)
+{ int *s;
+  int k;
+  s = Malloc(f->width*sizeof(int));
+  for (k=0; k<f->width; k++) s[k] = unknown;
+  FLOWHEIGHT(s) = 0;
+  return s;
+}
+
+int *flowIn(FLOW *f, int i)
+{ if (f->state==NULL || i<0 || i>=f->count) return NULL;
+  if (FLOWHEIGHT(f->state+i*f->width)==-1) return NULL;
+  return f->state+i*f->width;
+}
+
+/* merges state s into the entry state of instruction i,
+ * returns 1 if that changed anything.
+ */
+int flowMerge(FLOW *f, int i, int *s, FLOWJOIN join)
+{ int *d;
+  int k, v, change;
+  if (i>=f->count) return 0;
+  d = f->state+i*f->width;
+  if (FLOWHEIGHT(d)==-1) {
+     memcpy(d,s,f->width*sizeof(int));
+     return 1;
+  }
+  change = 0;
+  for (k=0; k<FLOWHEIGHT(d); k++) {
+      v = join(FLOWSTACK(f,d,k),FLOWSTACK(f,s,k));
+      if (v!=FLOWSTACK(f,d,k)) { FLOWSTACK(f,d,k) = v; change = 1; }
+  }
+  for (k=0; k<f->localslimit; k++) {
+      v = join(FLOWLOCAL(f,d,k),FLOWLOCAL(f,s,k));
+      if (v!=FLOWLOCAL(f,d,k)) { FLOWLOCAL(f,d,k) = v; change = 1; }
+  }
+  return change;
+}
+
+void flowSolve(FLOW *f, int *entry, FLOWJOIN join, FLOWTRANSFER transfer)
+{ int *work, *queued, *fall, *taken;
+  int i, top;
+
+  f->state = Malloc((f->count+1)*f->width*sizeof(int));
+  for (i=0; i<f->count; i++) FLOWHEIGHT(f->state+i*f->width) = -1;
+  if (f->count==0) return;
+  work = Malloc((f->count+1)*sizeof(int));
+  queued = Malloc((f->count+1)*sizeof(int));
+  fall = Malloc(f->width*sizeof(int));
+  taken = Malloc(f->width*sizeof(int));
+  for (i=0; i<f->count; i++) queued[i] = 0;
+
+  flowMerge(f,0,entry,join);
+  top = 0;
+  work[top++] = 0;
+  queued[0] = 1;
+  while (top>0) {
+    i = work[--top];
+    queued[i] = 0;
+    memcpy(fall,f->state+i*f->width,f->width*sizeof(int));
+    transfer(f,i,fall,taken);
+    if (f->target[i]!=-1 && flowMerge(f,f->target[i],taken,join) &&
+        !queued[f->target[i]]) {
+       queued[f->target[i]] = 1;
+       work[top++] = f->target[i];
+    }
+    if (flowFallsThrough(f->code[i]) && flowMerge(f,i+1,fall,join) &&
+        !queued[i+1]) {
+       queued[i+1] = 1;
+       work[top++] = i+1;
+    }
+  }
+}
+
+/* the effect of code[i] on s for an analysis that knows nothing about the
+ * instruction: loads, stores and stack shuffles move values around, every
+ * other pushed value is unknown.  For branches the same state is valid on
+ * both edges.
+ */
+void flowDefault(FLOW *f, int i, int *s, int unknown)
+{ CODE *c;
+  int inc, affected, used, k, h, v;
+  c = f->code[i];
+  h = FLOWHEIGHT(s);
+  switch (c->kind) {
+    case aloadCK:
+         FLOWSTACK(f,s,h) = FLOWLOCAL(f,s,c->val.aloadC);
+         FLOWHEIGHT(s) = h+1;
+         break;
+    case iloadCK:
+         FLOWSTACK(f,s,h) = FLOWLOCAL(f,s,c->val.iloadC);
+         FLOWHEIGHT(s) = h+1;
+         break;
+    case astoreCK:
+         FLOWLOCAL(f,s,c->val.astoreC) = FLOWSTACK(f,s,h-1);
+         FLOWHEIGHT(s) = h-1;
+         break;
+    case istoreCK:
+         FLOWLOCAL(f,s,c->val.istoreC) = FLOWSTACK(f,s,h-1);
+         FLOWHEIGHT(s) = h-1;
+         break;
+    case iincCK:
+         FLOWLOCAL(f,s,c->val.iincC.offset) = unknown;
+         break;
+    case dupCK:
+         FLOWSTACK(f,s,h) = FLOWSTACK(f,s,h-1);
+         FLOWHEIGHT(s) = h+1;
+         break;
+    case swapCK:
+         v = FLOWSTACK(f,s,h-1);
+         FLOWSTACK(f,s,h-1) = FLOWSTACK(f,s,h-2);
+         FLOWSTACK(f,s,h-2) = v;
+         break;
+    default:
+         stack_effect(c,&inc,&affected,&used);
+         for (k=h+affected; k<h+inc; k++) FLOWSTACK(f,s,k) = unknown;
+         FLOWHEIGHT(s) = h+inc;
+         break;
+  }
+}
+
+/* the successors of code[i]; returns how many there are */
+int flowSuccessors(FLOW *f, int i, int *succ)
+{ int n = 0;
+  if (f->target[i]!=-1) succ[n++] = f->target[i];
+  if (flowFallsThrough(f->code[i]) && i+1<f->count) succ[n++] = i+1;
+  return n;
+}
+
+/* Solves a must-problem over one fact: on return avail[i] is 1 if on every
+ * path to code[i] some instruction with gen set occurs after the last one
+ * with kill set.  Unreachable instructions get 0.
+ */
+char *flowAvailable(FLOW *f, char *gen, char *kill)
+{ char *avail;
+  int *work, succ[2];
+  int i, j, n, top, out;
+  avail = Malloc(f->count+1);
+  for (i=0; i<f->count; i++) avail[i] = 1;
+  if (f->count==0) return avail;
+  avail[0] = 0;
+  /* every instruction is queued at most once more, when it drops to 0 */
+  work = Malloc((2*f->count+1)*sizeof(int));
+  top = 0;
+  for (i=f->count-1; i>=0; i--) {
+      if (f->height[i]!=-1) work[top++] = i;
+  }
+  while (top>0) {
+    i = work[--top];
+    out = gen[i] || (avail[i] && !kill[i]);
+    if (out) continue;
+    n = flowSuccessors(f,i,succ);
+    for (j=0; j<n; j++) {
+        if (avail[succ[j]]) {
+           avail[succ[j]] = 0;
+           work[top++] = succ[j];
+        }
+    }
+  }
+  for (i=0; i<f->count; i++) {
+      if (f->height[i]==-1) avail[i] = 0;
+  }
+  return avail;
+}
+
+/* Solves a may-problem backwards: on return live[i] is 1 if some path from
+ * just after code[i] reaches an instruction with use set before one with
+ * def set.
+ */
+char *flowLive(FLOW *f, char *use, char *def)
+{ char *live, *in;
+  int succ[2];
+  int i, j, n, change, v;
+  live = Malloc(f->count+1);
+  in = Malloc(f->count+1);
+  for (i=0; i<f->count; i++) live[i] = in[i] = 0;
+  change = 1;
+  while (change) {
+    change = 0;
+    for (i=f->count-1; i>=0; i--) {
+        n = flowSuccessors(f,i,succ);
+        v = 0;
+        for (j=0; j<n; j++) v = v || in[succ[j]];
+        live[i] = v;
+        v = use[i] || (v && !def[i]);
+        if (v!=in[i]) { in[i] = v; change = 1; }
+    }
+  }
+  return live;
+}
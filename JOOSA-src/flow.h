@@ -0,0 +1,60 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* A FLOW is the code of one method flattened into an array, together with
+ * the stack height before every instruction and, once flowSolve has run,
+ * one abstract state per reachable instruction.
+ *
+ * A state is an array of ints laid out as
+ *   [ height | stack[0..stacklimit) | locals[0..localslimit) ]
+ * where the meaning of each value is up to the analysis.
+ */
+
+typedef struct FLOW {
+  CODE **code;        /* code[i] is the i-th instruction */
+  int count;
+  int *target;        /* index of the branch target of code[i], or -1 */
+  int *height;        /* stack height before code[i], or -1 if unreachable */
+  int *labelindex;    /* label number -> index of its labelCK */
+  int labelcount;
+  int stacklimit;
+  int localslimit;
+  int width;          /* size of one state */
+  int *state;         /* count states of size width, filled by flowSolve */
+} FLOW;
+
+#define FLOWHEIGHT(s) ((s)[0])
+#define FLOWSTACK(f,s,k) ((s)[1+(k)])
+#define FLOWTOP(f,s,k) ((s)[(s)[0]+1-(k)])
+#define FLOWLOCAL(f,s,k) ((s)[1+(f)->stacklimit+(k)])
+
+typedef int (*FLOWJOIN)(int a, int b);
+
+/* transfer(f,i,fall,taken): on entry fall holds a copy of the state before
+ * code[i]; it must leave the state after code[i] on the fall-through edge in
+ * fall and the state on the branch edge in taken (only used when
+ * f->target[i]!=-1).
+ */
+typedef void (*FLOWTRANSFER)(FLOW *f, int i, int *fall, int *taken);
+
+FLOW *flowCODE(CODE *c, int localslimit);
+int *flowEntry(FLOW *f, int unknown);
+void flowSolve(FLOW *f, int *entry, FLOWJOIN join, FLOWTRANSFER transfer);
+int *flowIn(FLOW *f, int i);
+void flowDefault(FLOW *f, int i, int *s, int unknown);
+int flowFallsThrough(CODE *c);
+int flowIndex(FLOW *f, CODE *c);
+int flowSuccessors(FLOW *f, int i, int *succ);
+char *flowAvailable(FLOW *f, char *gen, char *kill);
+char *flowLive(FLOW *f, char *use, char *def);
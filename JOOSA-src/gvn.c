@@ -0,0 +1,215 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memory.h"
+#include "flow.h"
+#include "codeinfo.h"
+#include "gvn.h"
+
+int gvnremoved;
+
+int gvnOperator(CODE *c)
+{ switch (c->kind) {
+    case iaddCK:
+    case isubCK:
+    case imulCK:
+    case idivCK:
+    case iremCK:
+    case inegCK:
+    case i2cCK:
+         return 1;
+    default:
+         return 0;
+  }
+}
+
+/* The canonical form of the expression computed by code[a..b], in which the
+ * operands of + and * are sorted, so that equal forms compute equal values
+ * from equal locals.  A division by zero would have stopped the first
+ * computation, so reusing its result is safe.
+ */
+char *gvnForm(FLOW *f, int a, int b)
+{ char **stack, *x, *y, *s;
+  int i, n;
+  stack = Malloc((b-a+2)*sizeof(char *));
+  n = 0;
+  for (i=a; i<=b; i++) {
+      s = Malloc(32);
+      switch (f->code[i]->kind) {
+        case iloadCK:
+             sprintf(s,"L%i",f->code[i]->val.iloadC);
+             break;
+        case ldc_intCK:
+             sprintf(s,"#%i",f->code[i]->val.ldc_intC);
+             break;
+        case inegCK:
+        case i2cCK:
+             x = stack[--n];
+             s = Malloc(strlen(x)+8);
+             sprintf(s,"(%s %s)",codeinfo[f->code[i]->kind].name,x);
+             break;
+        default:
+             y = stack[--n];
+             x = stack[--n];
+             if ((f->code[i]->kind==iaddCK || f->code[i]->kind==imulCK) &&
+                 strcmp(x,y)>0) {
+                s = x; x = y; y = s;
+             }
+             s = Malloc(strlen(x)+strlen(y)+12);
+             sprintf(s,"(%s %s %s)",codeinfo[f->code[i]->kind].name,x,y);
+             break;
+      }
+      stack[n++] = s;
+  }
+  return stack[0];
+}
+
+/* the first instruction of the expression ending with the operator at b,
+ * or -1 if it is not made of loads, constants and operators alone
+ */
+int gvnStart(FLOW *f, int b)
+{ int i, need;
+  if (f->height[b]==-1 || !gvnOperator(f->code[b])) return -1;
+  need = 1;
+  for (i=b; i>=0; i--) {
+      if (f->code[i]->kind!=iloadCK && f->code[i]->kind!=ldc_intCK &&
+          !gvnOperator(f->code[i])) return -1;
+      need += codeinfoPops(f->code[i])-1;
+      if (need==0) return i;
+  }
+  return -1;
+}
+
+int gvnSize(FLOW *f, int a, int b)
+{ int i, size;
+  size = 0;
+  for (i=a; i<=b; i++) size += codeinfoSize(f->code[i]);
+  return size;
+}
+
+int gvnLoadSize(int k)
+{ return k<4 ? 1 : 2;
+}
+
+/* Replaces the repeated occurrences of the expression form, as loadField in
+ * load.c does for field loads: the first occurrence on each path copies its
+ * value into local t and every later one available on all paths loads t.
+ */
+int gvnExpression(CODE *c, char *form, int t)
+{ FLOW *f;
+  char *gen, *kill, *avail, *use, *def, *live, *reads;
+  int *start, i, k, reuses, copies, saved, last;
+  CODE *g;
+
+  f = flowCODE(c,t);
+  start = Malloc((f->count+1)*sizeof(int));
+  reads = Malloc(t+1);
+  for (k=0; k<t; k++) reads[k] = 0;
+  last = -1;
+  for (i=0; i<f->count; i++) {
+      start[i] = gvnStart(f,i);
+      if (start[i]<=last || strcmp(gvnForm(f,start[i],i),form)!=0) {
+         start[i] = -1;
+         continue;
+      }
+      last = i;
+      for (k=start[i]; k<i; k++) {
+          if (f->code[k]->kind==iloadCK) reads[f->code[k]->val.iloadC] = 1;
+      }
+  }
+
+  gen = Malloc(f->count+1);
+  kill = Malloc(f->count+1);
+  for (i=0; i<f->count; i++) {
+      gen[i] = start[i]!=-1;
+      k = f->code[i]->kind==istoreCK ? f->code[i]->val.istoreC :
+          f->code[i]->kind==iincCK ? f->code[i]->val.iincC.offset : -1;
+      kill[i] = k!=-1 && k<t && reads[k];
+  }
+  avail = flowAvailable(f,gen,kill);
+
+  use = Malloc(f->count+1);
+  def = Malloc(f->count+1);
+  for (i=0; i<f->count; i++) use[i] = def[i] = 0;
+  for (i=0; i<f->count; i++) {
+      if (start[i]==-1) continue;
+      if (avail[start[i]]) use[start[i]] = 1; else def[i] = 1;
+  }
+  live = flowLive(f,use,def);
+
+  reuses = copies = saved = 0;
+  for (i=0; i<f->count; i++) {
+      if (start[i]!=-1 && use[start[i]]) {
+         reuses++;
+         saved += gvnSize(f,start[i],i)-gvnLoadSize(t);
+      }
+      if (def[i] && live[i]) {
+         copies++;
+         saved -= 1+gvnLoadSize(t);
+      }
+  }
+  if (reuses==0 || saved<=0) return 0;
+
+  for (i=0; i<f->count; i++) {
+      if (start[i]==-1) continue;
+      if (use[start[i]]) {
+         g = f->code[start[i]];
+         g->kind = iloadCK;
+         g->val.iloadC = t;
+         g->next = f->code[i]->next;
+      } else if (live[i]) {
+         g = f->code[i];
+         g->next = makeCODEdup(makeCODEistore(t,g->next));
+      }
+  }
+  gvnremoved += reuses;
+  return 1;
+}
+
+int gvnLonger(const void *a, const void *b)
+{ return ((int *)b)[1]-((int *)a)[1];
+}
+
+int gvnCODE(CODE *c, int *localslimit)
+{ FLOW *f;
+  int *sites, i, j, n, a;
+  char *form;
+  f = flowCODE(c,*localslimit);
+  /* pairs of (end, length), longest expressions first */
+  sites = Malloc((2*f->count+1)*sizeof(int));
+  n = 0;
+  for (i=0; i<f->count; i++) {
+      a = gvnStart(f,i);
+      if (a==-1) continue;
+      sites[2*n] = i;
+      sites[2*n+1] = i-a;
+      n++;
+  }
+  qsort(sites,n,2*sizeof(int),gvnLonger);
+  for (i=0; i<n; i++) {
+      form = gvnForm(f,sites[2*i]-sites[2*i+1],sites[2*i]);
+      /* each form is tried at its first site only */
+      for (j=0; j<i; j++) {
+          if (sites[2*j+1]==sites[2*i+1] &&
+              strcmp(gvnForm(f,sites[2*j]-sites[2*j+1],sites[2*j]),form)==0) break;
+      }
+      if (j<i) continue;
+      if (gvnExpression(c,form,*localslimit)) {
+         (*localslimit)++;
+         return 1;
+      }
+  }
+  return 0;
+}
@@ -0,0 +1,22 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Global value numbering of integer expressions: a pure computation on
+ * locals and constants that is repeated while its locals are unchanged is
+ * computed once into a fresh local and loaded from there afterwards.
+ */
+
+extern int gvnremoved;
+
+int gvnCODE(CODE *c, int *localslimit);
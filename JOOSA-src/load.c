@@ -0,0 +1,153 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "flow.h"
+#include "load.h"
+
+int loadremoved;
+
+/* splits "Class/f T" into the field name and its descriptor */
+char *loadName(char *field)
+{ char *space, *slash, *s;
+  space = strchr(field,' ');
+  if (space==NULL) return field;
+  for (slash=space; slash>field && *slash!='/'; slash--);
+  if (*slash=='/') slash++;
+  s = Malloc(space-slash+1);
+  strncpy(s,slash,space-slash);
+  s[space-slash] = '\0';
+  return s;
+}
+
+char *loadDescriptor(char *field)
+{ char *space;
+  space = strchr(field,' ');
+  return space==NULL ? "" : space+1;
+}
+
+/* A putfield can only overwrite the value read by getfield field if it
+ * stores a field of the same name and type; a call may store anything.
+ */
+int loadClobbers(CODE *c, char *field, int receiver)
+{ switch (c->kind) {
+    case astoreCK:
+         return c->val.astoreC==receiver;
+    case putfieldCK:
+         return strcmp(loadName(c->val.putfieldC),loadName(field))==0 &&
+                strcmp(loadDescriptor(c->val.putfieldC),loadDescriptor(field))==0;
+    case invokevirtualCK:
+    case invokenonvirtualCK:
+         return 1;
+    default:
+         return 0;
+  }
+}
+
+int loadSize(int k)
+{ return k<4 ? 1 : 2;
+}
+
+int loadIsSite(FLOW *f, int i, int receiver, char *field)
+{ return i+1<f->count && f->code[i]->kind==aloadCK &&
+         f->code[i]->val.aloadC==receiver &&
+         f->code[i+1]->kind==getfieldCK &&
+         strcmp(f->code[i+1]->val.getfieldC,field)==0;
+}
+
+/* Eliminates the redundant occurrences of "aload receiver; getfield field".
+ * The first load on each path copies its value into local t, every later
+ * one where the load is available on all paths becomes a load of t.  Copies
+ * that no later load reads are not made, and nothing is done unless the
+ * code gets smaller.
+ */
+int loadField(CODE *c, int receiver, char *field, int t)
+{ FLOW *f;
+  char *gen, *kill, *avail, *use, *def, *live;
+  int i, reuses, copies, saved, isref;
+  CODE *g;
+
+  f = flowCODE(c,t);
+  gen = Malloc(f->count+1);
+  kill = Malloc(f->count+1);
+  for (i=0; i<f->count; i++) {
+      gen[i] = i>0 && loadIsSite(f,i-1,receiver,field);
+      kill[i] = loadClobbers(f->code[i],field,receiver);
+  }
+  avail = flowAvailable(f,gen,kill);
+
+  use = Malloc(f->count+1);
+  def = Malloc(f->count+1);
+  for (i=0; i<f->count; i++) use[i] = def[i] = 0;
+  for (i=0; i<f->count; i++) {
+      if (f->height[i]==-1 || !loadIsSite(f,i,receiver,field)) continue;
+      if (avail[i]) use[i] = 1; else def[i+1] = 1;
+  }
+  live = flowLive(f,use,def);
+
+  reuses = copies = 0;
+  for (i=0; i<f->count; i++) {
+      if (use[i]) reuses++;
+      if (def[i] && live[i]) copies++;
+  }
+  saved = reuses*(loadSize(receiver)+3-loadSize(t)) - copies*(1+loadSize(t));
+  if (reuses==0 || saved<=0) return 0;
+
+  isref = loadDescriptor(field)[0]=='L';
+  for (i=0; i<f->count; i++) {
+      if (def[i] && live[i]) {
+         g = f->code[i];
+         if (isref) {
+            g->next = makeCODEdup(makeCODEastore(t,g->next));
+         } else {
+            g->next = makeCODEdup(makeCODEistore(t,g->next));
+         }
+      } else if (use[i]) {
+         g = f->code[i];
+         if (isref) {
+            g->kind = aloadCK;
+            g->val.aloadC = t;
+         } else {
+            g->kind = iloadCK;
+            g->val.iloadC = t;
+         }
+         g->next = f->code[i+1]->next;
+      }
+  }
+  loadremoved += reuses;
+  return 1;
+}
+
+int loadCODE(CODE *c, int *localslimit)
+{ FLOW *f;
+  int i, j, count;
+  f = flowCODE(c,*localslimit);
+  for (i=0; i+1<f->count; i++) {
+      if (f->code[i]->kind!=aloadCK || f->code[i+1]->kind!=getfieldCK) continue;
+      /* each pair is tried at its first occurrence only */
+      count = 0;
+      for (j=0; j+1<f->count; j++) {
+          if (loadIsSite(f,j,f->code[i]->val.aloadC,f->code[i+1]->val.getfieldC)) {
+             if (j<i) break;
+             count++;
+          }
+      }
+      if (count>1 &&
+          loadField(c,f->code[i]->val.aloadC,f->code[i+1]->val.getfieldC,*localslimit)) {
+         (*localslimit)++;
+         return 1;
+      }
+  }
+  return 0;
+}
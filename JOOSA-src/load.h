@@ -0,0 +1,21 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Redundant field load elimination: "aload k; getfield f" is replaced by a
+ * load of a fresh local when the same load is available on every path.
+ */
+
+extern int loadremoved;
+
+int loadCODE(CODE *c, int *localslimit);
@@ -0,0 +1,202 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include "memory.h"
+#include "flow.h"
+#include "codeinfo.h"
+#include "loop.h"
+
+int loopreduced;
+
+#define LOOPBUDGET 0
+
+/* Recognizes "iload i; ldc k; imul", "ldc k; iload i; imul" and
+ * "iload i; dup; iadd" at code[x], optionally followed by "ldc c; iadd"
+ * or "ldc c; isub".  Returns the number of instructions, or 0.
+ */
+int loopDerived(FLOW *f, int x, int *i, int *k, int *c)
+{ CODE **p;
+  int n;
+  unsigned u;
+  if (x+2>=f->count) return 0;
+  p = f->code+x;
+  if (p[0]->kind==iloadCK && p[1]->kind==ldc_intCK && p[2]->kind==imulCK) {
+     *i = p[0]->val.iloadC;
+     *k = p[1]->val.ldc_intC;
+  } else if (p[0]->kind==ldc_intCK && p[1]->kind==iloadCK && p[2]->kind==imulCK) {
+     *i = p[1]->val.iloadC;
+     *k = p[0]->val.ldc_intC;
+  } else if (p[0]->kind==iloadCK && p[1]->kind==dupCK && p[2]->kind==iaddCK) {
+     *i = p[0]->val.iloadC;
+     *k = 2;
+  } else {
+     return 0;
+  }
+  n = 3;
+  *c = 0;
+  if (x+4<f->count && p[3]->kind==ldc_intCK &&
+      (p[4]->kind==iaddCK || p[4]->kind==isubCK)) {
+     u = (unsigned)p[3]->val.ldc_intC;
+     *c = (int)(p[4]->kind==iaddCK ? u : 0u-u);
+     n = 5;
+  }
+  return n;
+}
+
+int loopSize(CODE **p, int n)
+{ int s;
+  for (s=0; n>0; n--, p++) s += codeinfoSize(*p);
+  return s;
+}
+
+int loopLdcSize(int v)
+{ return v>=-1 && v<=5 ? 1 : v>=-128 && v<=127 ? 2 : 3;
+}
+
+int loopLocalSize(int k)
+{ return k<4 ? 1 : k<256 ? 2 : 4;
+}
+
+/* 1 if the loop code[h..e] is entered only by falling into its head */
+int loopSingleEntry(FLOW *f, int h, int e)
+{ int p, j, n, succ[2];
+  if (h==0 || f->height[h-1]==-1 || !flowFallsThrough(f->code[h-1]) ||
+      f->target[h-1]==h) return 0;
+  for (p=0; p<f->count; p++) {
+      if ((p>=h && p<=e) || f->height[p]==-1) continue;
+      n = flowSuccessors(f,p,succ);
+      for (j=0; j<n; j++) {
+          if (succ[j]>=h && succ[j]<=e && !(p==h-1 && succ[j]==h)) return 0;
+      }
+  }
+  return 1;
+}
+
+/* the only instruction of code[h..e] that assigns i, if it is an iinc */
+int loopIncrement(FLOW *f, int h, int e, int i)
+{ int x, inc;
+  inc = -1;
+  for (x=h; x<=e; x++) {
+      switch (f->code[x]->kind) {
+        case istoreCK:
+        case astoreCK:
+             if (codeinfoInt(f->code[x])==i) return -1;
+             break;
+        case iincCK:
+             if (f->code[x]->val.iincC.offset!=i) break;
+             if (inc!=-1) return -1;
+             inc = x;
+             break;
+        default:
+             break;
+      }
+  }
+  return inc;
+}
+
+/* Strength reduces i*k+c in the loop code[h..e] into the fresh local t.
+ * t is set in front of the loop, from the constant i starts with when
+ * that is stored just before, and each "iinc i a" is followed by
+ * "iinc t a*k".  When the loop was the only reader of i, that was last
+ * stored just before the loop, its iinc goes.  Nothing is done if the code
+ * would grow by more than LOOPBUDGET bytes.
+ */
+int loopReduce(FLOW *f, int h, int e, int i, int k, int c, int t)
+{ CODE *pre, *g;
+  int x, n, inc, a, i2, k2, c2, start, sites, saved, reads, dead;
+  unsigned step, init;
+
+  inc = loopIncrement(f,h,e,i);
+  if (inc==-1) return 0;
+  step = (unsigned)f->code[inc]->val.iincC.amount*(unsigned)k;
+  a = (int)step;
+  if (a<-32768 || a>32767) return 0;
+
+  sites = saved = 0;
+  for (x=h; x<=e; x++) {
+      n = loopDerived(f,x,&i2,&k2,&c2);
+      if (n==0 || i2!=i || k2!=k || c2!=c) continue;
+      sites++;
+      saved += loopSize(f->code+x,n)-loopLocalSize(t);
+      x += n-1;
+  }
+  reads = 0;
+  for (x=0; x<f->count; x++) {
+      if (f->code[x]->kind==iloadCK && f->code[x]->val.iloadC==i) reads++;
+  }
+
+  start = h>=2 && f->code[h-1]->kind==istoreCK && f->code[h-1]->val.istoreC==i &&
+          f->code[h-2]->kind==ldc_intCK;
+  dead = f->code[h-1]->kind==istoreCK && f->code[h-1]->val.istoreC==i &&
+         reads==sites;
+  if (start) {
+     init = (unsigned)f->code[h-2]->val.ldc_intC*(unsigned)k+(unsigned)c;
+     saved -= loopLdcSize((int)init);
+  } else {
+     saved -= loopLocalSize(i)+(k==2 ? 2 : loopLdcSize(k)+1)+
+              (c==0 ? 0 : loopLdcSize(c)+1);
+  }
+  saved -= loopLocalSize(t)+(a>=-128 && a<=127 ? 3 : 6);
+  if (dead) saved += codeinfoSize(f->code[inc]);
+  if (sites==0 || saved<-LOOPBUDGET) return 0;
+
+  for (x=h; x<=e; x++) {
+      n = loopDerived(f,x,&i2,&k2,&c2);
+      if (n==0 || i2!=i || k2!=k || c2!=c) continue;
+      g = f->code[x];
+      g->kind = iloadCK;
+      g->val.iloadC = t;
+      g->next = f->code[x+n-1]->next;
+      x += n-1;
+  }
+  g = f->code[inc];
+  if (dead) {
+     g->val.iincC.offset = t;
+     g->val.iincC.amount = a;
+  } else {
+     g->next = makeCODEiinc(t,a,g->next);
+  }
+  pre = makeCODEistore(t,f->code[h]);
+  if (start) {
+     pre = makeCODEldc_int((int)init,pre);
+  } else {
+     if (c!=0) pre = makeCODEldc_int(c,makeCODEiadd(pre));
+     if (k==2) {
+        pre = makeCODEdup(makeCODEiadd(pre));
+     } else {
+        pre = makeCODEldc_int(k,makeCODEimul(pre));
+     }
+     pre = makeCODEiload(i,pre);
+  }
+  f->code[h-1]->next = pre;
+  loopreduced += sites;
+  return 1;
+}
+
+int loopCODE(CODE *c, int *localslimit)
+{ FLOW *f;
+  int e, h, x, i, k, d;
+  f = flowCODE(c,*localslimit);
+  for (e=0; e<f->count; e++) {
+      h = f->target[e];
+      if (h==-1 || h>e || f->height[e]==-1 || !loopSingleEntry(f,h,e)) continue;
+      for (x=h; x<=e; x++) {
+          if (loopDerived(f,x,&i,&k,&d) &&
+              loopReduce(f,h,e,i,k,d,*localslimit)) {
+             (*localslimit)++;
+             return 1;
+          }
+      }
+  }
+  return 0;
+}
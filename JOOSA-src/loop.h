@@ -0,0 +1,22 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Induction variable strength reduction: in a loop where a local changes
+ * only by one iinc, "i*k" and "i*k+c" are read from a fresh local that is
+ * incremented alongside i.
+ */
+
+extern int loopreduced;
+
+int loopCODE(CODE *c, int *localslimit);
@@ -22,7 +22,15 @@
 #include "defasn.h"
 #include "resource.h"
 #include "code.h"
+#include "cha.h"
+#include "reach.h"
+#include "field.h"
+#include "summary.h"
 #include "optimize.h"
+#include "superopt.h"
+#include "cache.h"
+#include "codeinfo.h"
+#include "trace.h"
 #include "emit.h"
 
 void yyparse();
@@ -33,14 +41,34 @@ PROGRAM *theprogram;
 CLASSFILE *theclassfile;
 
 int optionO;
+int optionS;
+char *optionR;
+char *optionC;
+char *optionT;
 
 int main(int argc, char **argv)
 { int i;
   theprogram = NULL;
   optionO = 0;
+  optionS = 0;
+  optionR = NULL;
+  optionC = NULL;
+  optionT = NULL;
   for (i=1; i<argc; i++) {
       if (strcmp(argv[i],"-O")==0) {
          optionO = 1;
+      } else if (strcmp(argv[i],"-S")==0) {
+         optionS = 1;
+      } else if (strcmp(argv[i],"-R")==0 && i+1<argc) {
+         optionR = argv[++i];
+      } else if (strcmp(argv[i],"-C")==0 && i+1<argc) {
+         optionC = argv[++i];
+      } else if (strncmp(argv[i],"-fopt-bisect-limit=",19)==0) {
+         optilimit = atoi(argv[i]+19);
+      } else if (strcmp(argv[i],"-fssa")==0) {
+         optissa = 1;
+      } else if (strcmp(argv[i],"-T")==0 && i+1<argc) {
+         optionT = argv[++i];
       } else {
          currentfile = argv[i];
          if (freopen(currentfile,"r",stdin) != NULL)
@@ -53,6 +81,12 @@ int main(int argc, char **argv)
          }
       }
   }
+  if (optionS && optionR==NULL) {
+     reportGlobalError("-S needs a rule database given with -R");
+  }
+  if (optionS && !optionO) {
+     reportGlobalError("-S needs -O");
+  }
   noErrors();
   weedPROGRAM(theprogram);
   noErrors();
@@ -64,7 +98,21 @@ int main(int argc, char **argv)
   noErrors();
   resPROGRAM(theprogram);
   codePROGRAM(theprogram);
-  if (optionO) optiPROGRAM(theprogram);
+  if (optionO) {
+     reachPROGRAM(theprogram);
+     fieldPROGRAM(theprogram);
+     chaPROGRAM(theprogram);
+     /* a method taken from the cache would not count its rewrites */
+     if (optionC!=NULL && optilimit<0) cacheOpen(optionC,theprogram);
+     if (optionT!=NULL) traceOpen(optionT);
+     if (optionR!=NULL) superLoad(optionR);
+     summaryPROGRAM(theprogram);
+     noErrors();
+     optiPROGRAM(theprogram);
+     cacheClose();
+     traceClose();
+     if (optionS) superPROGRAM(theprogram,optionR);
+  }
   emitPROGRAM(theprogram);
   return 0;
 }
@@ -0,0 +1,194 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <string.h>
+#include "memory.h"
+#include "flow.h"
+#include "codeinfo.h"
+#include "optimize.h"
+#include "summary.h"
+#include "nonnull.h"
+
+/* A value is a nullness, UNKNOWN, NONNULL or ISNULL, together with the
+ * local it was loaded from, if it still holds the same reference.  Testing
+ * or dereferencing such a value tells us about the local too.  Locals only
+ * hold a nullness.
+ */
+
+#define UNKNOWN 0
+#define NONNULL 1
+#define ISNULL 2
+#define STATE(v) ((v)&3)
+#define SOURCE(v) (((v)>>2)-1)
+#define MAKE(state,k) ((state)|(((k)+1)<<2))
+
+int nonnullfolded;
+
+int nonnullJoin(int a, int b)
+{ int state, k;
+  state = STATE(a)==STATE(b) ? STATE(a) : UNKNOWN;
+  k = SOURCE(a)==SOURCE(b) ? SOURCE(a) : -1;
+  return MAKE(state,k);
+}
+
+/* local k, and every copy of it on the stack, is known to be state */
+void nonnullRefine(FLOW *f, int *s, int k, int state)
+{ int j;
+  if (k==-1) return;
+  FLOWLOCAL(f,s,k) = state;
+  for (j=0; j<FLOWHEIGHT(s); j++) {
+      if (SOURCE(FLOWSTACK(f,s,j))==k) FLOWSTACK(f,s,j) = MAKE(state,k);
+  }
+}
+
+/* a store to local k leaves the values on the stack unconnected to it */
+void nonnullKill(FLOW *f, int *s, int k)
+{ int j;
+  for (j=0; j<FLOWHEIGHT(s); j++) {
+      if (SOURCE(FLOWSTACK(f,s,j))==k) {
+         FLOWSTACK(f,s,j) = MAKE(STATE(FLOWSTACK(f,s,j)),-1);
+      }
+  }
+}
+
+void nonnullTransfer(FLOW *f, int i, int *fall, int *taken)
+{ CODE *c, *constant;
+  int h, a, b, k, eq;
+  c = f->code[i];
+  h = FLOWHEIGHT(fall);
+  a = h>0 ? FLOWTOP(f,fall,1) : UNKNOWN;
+  b = h>1 ? FLOWTOP(f,fall,2) : UNKNOWN;
+  switch (c->kind) {
+    case aloadCK:
+         k = c->val.aloadC;
+         FLOWSTACK(f,fall,h) = MAKE(STATE(FLOWLOCAL(f,fall,k)),k);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case astoreCK:
+    case istoreCK:
+         k = codeinfoInt(c);
+         nonnullKill(f,fall,k);
+         FLOWLOCAL(f,fall,k) = STATE(a);
+         FLOWHEIGHT(fall) = h-1;
+         break;
+    case newCK:
+    case ldc_stringCK:
+         FLOWSTACK(f,fall,h) = MAKE(NONNULL,-1);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case aconst_nullCK:
+         FLOWSTACK(f,fall,h) = MAKE(ISNULL,-1);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case checkcastCK:
+         break;
+    case getfieldCK:
+    case putfieldCK:
+    case invokevirtualCK:
+    case invokenonvirtualCK:
+         /* execution only goes on if the receiver was not null */
+         k = SOURCE(FLOWTOP(f,fall,codeinfoPops(c)));
+         flowDefault(f,i,fall,UNKNOWN);
+         nonnullRefine(f,fall,k,NONNULL);
+         if (c->kind!=getfieldCK && codeinfoPushes(c) &&
+             (summaryCall(c,&constant)&SUMNONNULL)) {
+            FLOWTOP(f,fall,1) = MAKE(NONNULL,-1);
+         }
+         break;
+    default:
+         flowDefault(f,i,fall,UNKNOWN);
+         break;
+  }
+  memcpy(taken,fall,f->width*sizeof(int));
+  switch (c->kind) {
+    case ifnullCK:
+         nonnullRefine(f,taken,SOURCE(a),ISNULL);
+         nonnullRefine(f,fall,SOURCE(a),NONNULL);
+         break;
+    case ifnonnullCK:
+         nonnullRefine(f,taken,SOURCE(a),NONNULL);
+         nonnullRefine(f,fall,SOURCE(a),ISNULL);
+         break;
+    case if_acmpeqCK:
+    case if_acmpneCK:
+         /* comparing with null is a null test */
+         eq = c->kind==if_acmpeqCK;
+         if (STATE(a)==ISNULL) {
+            nonnullRefine(f,eq ? taken : fall,SOURCE(b),ISNULL);
+            nonnullRefine(f,eq ? fall : taken,SOURCE(b),NONNULL);
+         } else if (STATE(b)==ISNULL) {
+            nonnullRefine(f,eq ? taken : fall,SOURCE(a),ISNULL);
+            nonnullRefine(f,eq ? fall : taken,SOURCE(a),NONNULL);
+         }
+         break;
+    default:
+         break;
+  }
+}
+
+/* 1 if the test at i is always taken, 0 if never, -1 if not known */
+int nonnullDecide(CODE *c, int a, int b)
+{ int same;
+  switch (c->kind) {
+    case ifnullCK:
+    case ifnonnullCK:
+         if (STATE(a)==UNKNOWN) return -1;
+         return (STATE(a)==ISNULL)==(c->kind==ifnullCK);
+    case if_acmpeqCK:
+    case if_acmpneCK:
+         if ((STATE(a)==ISNULL && STATE(b)==ISNULL) ||
+             (SOURCE(a)!=-1 && SOURCE(a)==SOURCE(b))) {
+            same = 1;
+         } else if ((STATE(a)==ISNULL && STATE(b)==NONNULL) ||
+                    (STATE(a)==NONNULL && STATE(b)==ISNULL)) {
+            same = 0;
+         } else {
+            return -1;
+         }
+         return same==(c->kind==if_acmpeqCK);
+    default:
+         return -1;
+  }
+}
+
+int nonnullCODE(CODE *c, int isstatic, int localslimit)
+{ FLOW *f;
+  CODE *p, *r;
+  int *s, i, k, d, label, change;
+
+  f = flowCODE(c,localslimit);
+  s = flowEntry(f,UNKNOWN);
+  if (!isstatic && localslimit>0) FLOWLOCAL(f,s,0) = NONNULL;
+  flowSolve(f,s,nonnullJoin,nonnullTransfer);
+
+  change = 0;
+  for (i=0; i<f->count; i++) {
+      s = flowIn(f,i);
+      p = f->code[i];
+      if (s==NULL || !(codeinfo[p->kind].flags&CICONDITIONAL)) continue;
+      d = nonnullDecide(p,FLOWTOP(f,s,1),
+                        FLOWHEIGHT(s)>1 ? FLOWTOP(f,s,2) : UNKNOWN);
+      if (d==-1) continue;
+      label = codeinfoInt(p);
+      if (d) {
+         r = makeCODEgoto(label,p->next);
+      } else {
+         droplabel(label);
+         r = p->next;
+      }
+      for (k=codeinfoPops(p); k>0; k--) r = makeCODEpop(r);
+      *p = *r;
+      nonnullfolded++;
+      change = 1;
+  }
+  return change;
+}
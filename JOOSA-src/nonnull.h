@@ -0,0 +1,22 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Null-check elimination: ifnull, ifnonnull and if_acmp tests whose
+ * outcome follows from what is known about the nullness of their operands
+ * are replaced by pops and, if taken, a goto.
+ */
+
+extern int nonnullfolded;
+
+int nonnullCODE(CODE *c, int isstatic, int localslimit);
@@ -14,6 +14,24 @@
 #include <string.h>
 #include "memory.h"
 #include "optimize.h"
+#include "codeinfo.h"
+#include "cast.h"
+#include "nonnull.h"
+#include "range.h"
+#include "cond.h"
+#include "load.h"
+#include "loop.h"
+#include "copy.h"
+#include "gvn.h"
+#include "ssa.h"
+#include "ssaopt.h"
+#include "schedule.h"
+#include "tail.h"
+#include "switch.h"
+#include "summary.h"
+#include "superopt.h"
+#include "cache.h"
+#include "trace.h"
 
 /*****  isA  functions,  return true if the instruction pointed to by
  *****  the parameter c is an instruction of the given kind.
@@ -122,6 +140,20 @@ int is_goto(CODE *c, int *label)
   }
 }
 
+/* a tableswitch or lookupswitch, whose cases and default are in s */
+int is_switch(CODE *c, SWITCH **s)
+{ if (c==NULL) return 0;
+  if (c->kind == tableswitchCK) {
+     (*s) = c->val.tableswitchC;
+     return 1;
+  } else if (c->kind == lookupswitchCK) {
+     (*s) = c->val.lookupswitchC;
+     return 1;
+  } else {
+     return 0;
+  }
+}
+
 
 int is_ifeq(CODE *c, int *label)
 { if (c==NULL) return 0;
@@ -143,6 +175,46 @@ int is_ifne(CODE *c, int *label)
   }
 }
 
+int is_iflt(CODE *c, int *label)
+{ if (c==NULL) return 0;
+  if (c->kind == ifltCK) {
+     (*label) = c->val.ifltC;
+     return 1;
+  } else {
+     return 0;
+  }
+}
+
+int is_ifge(CODE *c, int *label)
+{ if (c==NULL) return 0;
+  if (c->kind == ifgeCK) {
+     (*label) = c->val.ifgeC;
+     return 1;
+  } else {
+     return 0;
+  }
+}
+
+int is_ifgt(CODE *c, int *label)
+{ if (c==NULL) return 0;
+  if (c->kind == ifgtCK) {
+     (*label) = c->val.ifgtC;
+     return 1;
+  } else {
+     return 0;
+  }
+}
+
+int is_ifle(CODE *c, int *label)
+{ if (c==NULL) return 0;
+  if (c->kind == ifleCK) {
+     (*label) = c->val.ifleC;
+     return 1;
+  } else {
+     return 0;
+  }
+}
+
 int is_if_acmpeq(CODE *c, int *label)
 { if (c==NULL) return 0;
   if (c->kind == if_acmpeqCK) {
@@ -250,24 +322,11 @@ int is_if_icmpne(CODE *c, int *label)
  */
  
 int is_if(CODE **c, int *label)
-{
-  if (is_ifeq(*c, label) ||
-      is_ifne(*c, label) ||
-      is_if_acmpeq(*c, label) ||
-      is_if_acmpne(*c, label) ||
-      is_ifnull(*c, label) ||
-      is_ifnonnull(*c, label) ||
-      is_if_icmpeq(*c, label) ||
-      is_if_icmpgt(*c, label) ||
-      is_if_icmplt(*c, label) ||
-      is_if_icmple(*c, label) ||
-      is_if_icmpge(*c, label) ||
-      is_if_icmpne(*c, label))
-      return 1;
-  return 0;
+{ if (*c==NULL || !(codeinfo[(*c)->kind].flags&CICONDITIONAL)) return 0;
+  (*label) = codeinfoInt(*c);
+  return 1;
 }
 
-
 int is_ireturn(CODE *c)
 { if (c==NULL) return 0;
   return c->kind==ireturnCK;
@@ -409,8 +468,7 @@ int is_empty(CODE *c)
 
 int is_simplepush(CODE *c)
 { if (c==NULL) return 0;
-  return (c->kind==aloadCK) || (c->kind==iloadCK) || (c->kind==ldc_intCK) || 
-         (c->kind==ldc_stringCK) || (c->kind==aconst_nullCK);
+  return codeinfo[c->kind].flags&CIPUSH;
 }
 
 
@@ -432,13 +490,9 @@ CODE * nextby(CODE *c, int by) {
 /******   Helper functions for dealing with labels ******/
 
 int uses_label(CODE *c, int *label)
-{ if (c==NULL) return 0;
-  return is_goto(c,label) || is_ifeq(c,label) || is_ifne(c,label) || 
-         is_if_acmpeq(c,label) || is_if_acmpne(c,label) || 
-         is_ifnull(c,label) || is_ifnonnull(c,label) ||
-         is_if_icmpeq(c,label) || is_if_icmpgt(c,label) || 
-         is_if_icmplt(c,label) || is_if_icmple(c,label) || 
-         is_if_icmpge(c,label) || is_if_icmpne(c,label);
+{ if (c==NULL || !(codeinfo[c->kind].flags&CIBRANCH)) return 0;
+  (*label) = codeinfoInt(c);
+  return 1;
 }
 
 LABEL *currentlabels;   /* points to current labels table */
@@ -460,6 +514,10 @@ void droplabel(int label)
 { currentlabels[label].sources--;
 }
 
+void movelabel(int label, CODE *position)
+{ currentlabels[label].position = position;
+}
+
 int deadlabel(int label)
 { return currentlabels[label].sources==0;
 }
@@ -576,149 +634,24 @@ int kill_line(CODE **c)
  * The return value of the function tell the user if the the code is of 
  * a type which might invalidate stack analysis:
  * 0: normal
- * 1: goto
+ * 1: goto or switch
  * 2: comparison
  * 3: label
  * 4: return
  */
 
 int stack_effect(CODE *c, int *inc, int *affected, int *used)
-{
-  char *stringpos;
-  if(c!=NULL) {
-    
-  switch(c->kind) {
-    case nopCK:
-	case iincCK:
-      *inc=*used=*affected=0;
-      break;
-      
-	case instanceofCK:
-    case getfieldCK:	
-    case i2cCK:
-    case inegCK:
-      *inc=0;
-      *used=*affected=-1;
-      break;
-      
-    case checkcastCK:
-      *inc = *affected =0;
-      *used= -1;
-      break;
-    
-    case swapCK:
-      *inc=0;
-      *used=*affected=-2;
-      break;
-
-    case labelCK:
-      *inc=*used=*affected=0;
-      return 3;
-      break; 
-      
-    case newCK:
-    case iloadCK:
-    case aloadCK:
-    case ldc_intCK:
-    case ldc_stringCK:
-    case aconst_nullCK:
-      *inc = +1;
-      *affected=*used=0;
-      break;
-      
-    case dupCK:
-      *inc=1;
-      *affected=0;
-      *used=-1;
-      break;
-      
-    case popCK:	
-    case istoreCK:
-    case astoreCK:
-      *inc=*used=*affected= -1;
-      break;
-
-    case iremCK:
-    case isubCK:
-    case idivCK:
-    case iaddCK:
-    case imulCK:
-      *inc=-1;
-      *used=*affected=-2;
-      break;
-      
-    case putfieldCK:
-      *used=*affected=*inc = -2;
-      break;
-      
-    case invokevirtualCK:
-    case invokenonvirtualCK:
-      *inc=-1; /* receiver */
-      if(c->kind==invokevirtualCK)
-        stringpos = c->val.invokevirtualC;
-      else
-        stringpos = c->val.invokenonvirtualC;
-      
-      while((*stringpos) != '(') stringpos++;
-      stringpos++;
-
-      /* one for each formal */
-      while((*stringpos) != ')') {
-        (*inc)--;
-        if((*stringpos)=='L')
-          while((*stringpos)!=';') stringpos++;
-        stringpos++;
-      }
-      stringpos++;
-
-      *used = *affected = *inc;	
-
-      /* if not void, then pushes return value */
-      if((*stringpos)!='V')
-        (*inc)++;
-      break;
-      
-    case gotoCK:
-      *used = *affected = *inc =0;
-      return 1;
-      break;
-      
-    case ifeqCK:
-    case ifneCK:
-    case ifnullCK:
-    case ifnonnullCK:
-      *inc = *used = *affected = -1;
-      return 2;
-      break;
-      
-    case if_icmpeqCK:
-    case if_icmpneCK:
-    case if_icmpgtCK:
-    case if_icmpltCK:
-    case if_icmpleCK:
-    case if_icmpgeCK:
-    case if_acmpeqCK:
-    case if_acmpneCK:
-      *inc = *used = *affected = -2;
-      return 2;
-      break;
-      
-    case returnCK:
-      *inc = *used = *affected = 0;
-      return 4;
-    case areturnCK:
-    case ireturnCK:
-      *inc = *used = *affected = -1;
-      return 4;
-      break;
-      
-    default:
-      printf("Stack_Effect: unrecognized code kind\n");
-      *inc=*used=*affected=0;
-      break;
-    }
-  }
-  return 0;  
+{ int flags;
+  if (c==NULL) return 0;
+  flags = codeinfo[c->kind].flags;
+  *used = -codeinfoPops(c);
+  *inc = *used+codeinfoPushes(c);
+  *affected = (flags&CIKEEPS) ? 0 : *used;
+  if (c->kind==labelCK) return 3;
+  if (flags&CICONDITIONAL) return 2;
+  if ((flags&CIBRANCH) || codeinfo[c->kind].operand==CISWITCH) return 1;
+  if (flags&CITERMINATOR) return 4;
+  return 0;
 }
 
 typedef int(*OPTI)(CODE **);
@@ -766,6 +699,61 @@ int add_pattern(char *name, OPTI pattern) {return 0;}
 
 
 int optiCHANGE;
+int optisweep;     /* passes over the current method */
+CODE **opticode;   /* the current method */
+char *optimethod;  /* and its name */
+
+/* -fopt-bisect-limit=N: only the first N rewrites of the program are made,
+ * and the N-th is reported.  A rewrite is one successful pattern, one run
+ * of a global pass that changed the method, or one change that reach.c,
+ * field.c or cha.c make before optiPROGRAM.
+ */
+int optilimit = -1;
+int optirewrites = 0;
+
+/* -fssa: the global passes also rewrite each method through ssa.c */
+int optissa = 0;
+
+/* names the method, or the class when member is NULL, that the next
+ * reported rewrite is in
+ */
+void optiName(char *class, char *member)
+{ if (member==NULL) {
+     optimethod = class;
+     return;
+  }
+  optimethod = Malloc(strlen(class)+strlen(member)+2);
+  sprintf(optimethod,"%s.%s",class,member);
+}
+
+int optiAllowed()
+{ return optilimit<0 || optirewrites<optilimit;
+}
+
+/* the global passes, which the trace numbers after the patterns */
+char *optipasses[] = {"tailCODE","castCODE","nonnullCODE","rangeCODE",
+                      "condCODE","summaryCODE","loadCODE","loopCODE",
+                      "copyCODE","gvnCODE","ssaCODE","scheduleCODE",
+                      "switchCODE",NULL};
+
+void optiRewrite(char *name, CODE *at)
+{ CODE *p;
+  int position, i;
+  optirewrites++;
+  if (at==NULL && tracefile!=NULL) {
+     for (i=0; optipasses[i]!=NULL && strcmp(optipasses[i],name)!=0; i++);
+     if (optipasses[i]!=NULL) traceRewrite(optisweep,*opticode,NULL,OPTS+i);
+  }
+  if (optirewrites!=optilimit) return;
+  if (at==NULL) {
+     printf("opt-bisect: rewrite %d is %s on %s\n",optirewrites,name,optimethod);
+     return;
+  }
+  position = 0;
+  for (p=*opticode; p!=NULL && p!=at; p=p->next) position++;
+  printf("opt-bisect: rewrite %d is %s at instruction %d of %s\n",
+         optirewrites,name,position,optimethod);
+}
 
 void optiCODEtraverse(CODE **c)
 { int i,change;
@@ -775,8 +763,17 @@ void optiCODEtraverse(CODE **c)
        change = 0;
        for (i=0; i<OPTS; i++) {
 	  int optimized;
+	  if (optilimit>=0 && !optiAllowed()) break;
 	  optimized = optimization[i](c);
-	  if (optimized) frequencies[i]++;
+	  if (optimized) {
+	     frequencies[i]++;
+	     if (tracefile!=NULL) traceRewrite(optisweep,*opticode,*c,i);
+#ifndef OPTS
+	     if (optilimit>=0) optiRewrite(opti_name[i],*c);
+#else
+	     if (optilimit>=0) optiRewrite("a pattern",*c);
+#endif
+	  }
           change = change | optimized;
        }
        optiCHANGE = optiCHANGE || change;
@@ -786,13 +783,75 @@ void optiCODEtraverse(CODE **c)
 } 
 
 void optiCODE(CODE **c)
-{ optiCHANGE = 1;
+{ opticode = c;
+  optiCHANGE = 1;
   while (optiCHANGE) {
     optiCHANGE = 0;
+    optisweep++;
     optiCODEtraverse(c);
   }
 }
 
+CLASS *opticlass;
+
+/* The passes below look at a whole method rather than a window of
+ * instructions; whenever one of them changes the code the patterns get
+ * another go at the result.
+ */
+void optiGLOBAL(CODE **c, FORMAL *formals, char *signature, int *localslimit,
+                int isstatic)
+{ int change;
+  do {
+    change = 0;
+    if (optiAllowed() &&
+        castCODE(*c,isstatic ? NULL : opticlass,formals,*localslimit)) {
+       change = 1;
+       optiRewrite("castCODE",NULL);
+    }
+    if (optiAllowed() && nonnullCODE(*c,isstatic,*localslimit)) {
+       change = 1;
+       optiRewrite("nonnullCODE",NULL);
+    }
+    if (optiAllowed() && rangeCODE(*c,formals,*localslimit)) {
+       change = 1;
+       optiRewrite("rangeCODE",NULL);
+    }
+    if (optiAllowed() && condCODE(*c,*localslimit)) {
+       change = 1;
+       optiRewrite("condCODE",NULL);
+    }
+    if (optiAllowed() && summaryCODE(*c,isstatic,*localslimit)) {
+       change = 1;
+       optiRewrite("summaryCODE",NULL);
+    }
+    if (optiAllowed() && loadCODE(*c,localslimit)) {
+       change = 1;
+       optiRewrite("loadCODE",NULL);
+    }
+    if (optiAllowed() && loopCODE(*c,localslimit)) {
+       change = 1;
+       optiRewrite("loopCODE",NULL);
+    }
+    if (optiAllowed() && copyCODE(*c,signature,localslimit)) {
+       change = 1;
+       optiRewrite("copyCODE",NULL);
+    }
+    if (optiAllowed() && gvnCODE(*c,localslimit)) {
+       change = 1;
+       optiRewrite("gvnCODE",NULL);
+    }
+    if (optissa && optiAllowed() && ssaCODE(c,formals,signature,localslimit,isstatic)) {
+       change = 1;
+       optiRewrite("ssaCODE",NULL);
+    }
+    if (optiAllowed() && scheduleCODE(*c,*localslimit)) {
+       change = 1;
+       optiRewrite("scheduleCODE",NULL);
+    }
+    if (change) optiCODE(c);
+  } while (change);
+}
+
 void optiPROGRAMrec(PROGRAM *p)
 { if (p!=NULL) {
     optiPROGRAMrec(p->next);
@@ -805,10 +864,30 @@ void optiPROGRAM(PROGRAM *p)
   int i;
   for(i = 0; i < OPTS; i++)
     frequencies[i] = 0;
+  castremoved = castfolded = 0;
+  nonnullfolded = 0;
+  rangei2c = rangefolded = rangethreaded = 0;
+  condfolded = 0;
+  loadremoved = 0;
+  loopreduced = 0;
+  copiesremoved = 0;
+  gvnremoved = 0;
+  ssamethods = ssafolded = ssanumbered = ssaremoved = 0;
+  schedulepairs = 0;
+  tailcalls = 0;
+  switchchains = 0;
+  summaryremoved = summaryfolded = 0;
 
 #ifndef OPTS
   init_patterns();
+  for (i = 0; i < OPTS; i++) {
+    cacheMix(opti_name[i]);
+    tracePattern(i, opti_name[i]);
+  }
 #endif
+  for (i = 0; optipasses[i] != NULL; i++)
+    tracePattern(OPTS + i, optipasses[i]);
+  if (optissa) cacheMix("ssaCODE");
   
   if (p!=NULL) {
     optiPROGRAMrec(p->next);
@@ -824,6 +903,28 @@ void optiPROGRAM(PROGRAM *p)
 #endif
   
   printf("\n");
+  printf("checkcasts removed: %d, instanceofs folded: %d\n",
+         castremoved,castfolded);
+  printf("null tests folded: %d\n",nonnullfolded);
+  printf("i2cs removed: %d, integer tests folded: %d, jumps threaded: %d\n",
+         rangei2c,rangefolded,rangethreaded);
+  printf("implied conditions folded: %d\n",condfolded);
+  printf("getfields removed: %d\n",loadremoved);
+  printf("multiplications strength reduced: %d\n",loopreduced);
+  printf("local copies removed: %d\n",copiesremoved);
+  printf("expressions reused: %d\n",gvnremoved);
+  if (optissa)
+    printf("ssa methods rewritten: %d, values folded: %d, numbered: %d, "
+           "removed: %d\n",ssamethods,ssafolded,ssanumbered,ssaremoved);
+  printf("store/load pairs kept on the stack: %d\n",schedulepairs);
+  printf("tail calls removed: %d\n",tailcalls);
+  printf("equality chains made switches: %d\n",switchchains);
+  printf("calls removed: %d, calls folded: %d\n",summaryremoved,summaryfolded);
+  if (optilimit>=0)
+    printf("opt-bisect: %d rewrites made\n",optirewrites);
+  if (cachehits+cachemisses>0)
+    printf("methods taken from the cache: %d of %d\n",
+           cachehits,cachehits+cachemisses);
 }
 
 void optiCLASSFILE(CLASSFILE *c)
@@ -835,33 +936,69 @@ void optiCLASSFILE(CLASSFILE *c)
 
 void optiCLASS(CLASS *c)
 { if (!c->external) {
+     opticlass = c;
      optiCONSTRUCTOR(c->constructors);
      optiMETHOD(c->methods);
   }
 }
 
 void optiCONSTRUCTOR(CONSTRUCTOR *c)
-{ if (c!=NULL) {
+{ char *key;
+  if (c!=NULL) {
      optiCONSTRUCTOR(c->next);
+     key = cacheKey(c->opcodes,c->labels,c->labelcount,opticlass,
+                    c->signature,c->localslimit,0);
+     if (cacheFetch(key,&c->opcodes,&c->labels,&c->labelcount,&c->localslimit)) {
+        return;
+     }
+     optiName(opticlass->name,"<init>");
+     traceMethod(opticlass->name,"<init>",c->opcodes);
+     optisweep = 0;
      currentlabels = c->labels;
      currentlabelstable = &(c->labels);
      currentlabelstablesize = c->labelcount;
      _label=currentlabelstablesize-1;
      optiCODE(&c->opcodes);
+     optiGLOBAL(&c->opcodes,c->formals,c->signature,&c->localslimit,0);
+     if (optiAllowed() && switchCODE(&c->opcodes)) {
+        optiRewrite("switchCODE",NULL);
+        optiCODE(&c->opcodes);
+     }
      /* Feng fix */
      c->labelcount=_label+1;
+     cacheStore(key,c->opcodes,c->labels,c->labelcount,c->localslimit);
   }
 }
 
 void optiMETHOD(METHOD *m)
-{ if (m!=NULL) {
+{ char *key;
+  if (m!=NULL) {
      optiMETHOD(m->next);
+     key = cacheKey(m->opcodes,m->labels,m->labelcount,opticlass,
+                    m->signature,m->localslimit,m->modifier==staticMod);
+     if (cacheFetch(key,&m->opcodes,&m->labels,&m->labelcount,&m->localslimit)) {
+        return;
+     }
+     optiName(opticlass->name,m->name);
+     traceMethod(opticlass->name,m->name,m->opcodes);
+     optisweep = 0;
      currentlabels = m->labels;
      currentlabelstable = &(m->labels);
      currentlabelstablesize = m->labelcount;
      _label=currentlabelstablesize-1;
      optiCODE(&m->opcodes);
+     if (optiAllowed() && tailCODE(&m->opcodes,opticlass,m)) {
+        optiRewrite("tailCODE",NULL);
+        optiCODE(&m->opcodes);
+     }
+     optiGLOBAL(&m->opcodes,m->formals,m->signature,&m->localslimit,
+                m->modifier==staticMod);
+     if (optiAllowed() && switchCODE(&m->opcodes)) {
+        optiRewrite("switchCODE",NULL);
+        optiCODE(&m->opcodes);
+     }
      /* Feng fix */
      m->labelcount=_label+1;
+     cacheStore(key,m->opcodes,m->labels,m->labelcount,m->localslimit);
   }
 }
@@ -11,6 +11,9 @@
  */
 
 #include "tree.h"
+
+extern int optilimit;
+extern int optissa;
  
 void optiPROGRAM(PROGRAM *p);
 void optiCLASSFILE(CLASSFILE *c);
@@ -18,3 +21,16 @@ void optiCLASS(CLASS *c);
 void optiCONSTRUCTOR(CONSTRUCTOR *c);
 void optiMETHOD(METHOD *m);
 void optiCODE(CODE **c);
+void optiName(char *class, char *member);
+int optiAllowed();
+void optiRewrite(char *name, CODE *at);
+
+int uses_label(CODE *c, int *label);
+int replace(CODE **c, int k, CODE *r);
+int next_label();
+void INSERTnewlabel(int i,char* name,CODE *target,int count);
+int copylabel(int label);
+void droplabel(int label);
+void movelabel(int label, CODE *position);
+int deadlabel(int label);
+int stack_effect(CODE *c, int *inc, int *affected, int *used);
@@ -106,6 +106,28 @@ int dup_pop(CODE **c)
 }
 
 
+/* swap             [ b a ]
+ * swap             [ a b ]
+ * -------->
+ * nop              [ a b ]
+ *
+ * The second swap undoes the first, as left behind when scheduleCODE keeps
+ * a value on the stack right before an existing swap
+ *
+ * Improvement:
+ *      Reduces bytecode count
+ *
+ */
+int swap_swap(CODE **c)
+{
+  if (is_swap(*c) &&
+      is_swap(next(*c))) {
+    return replace(c,2,makeCODEnop(NULL));
+  }
+  return 0;
+}
+
+
 /* [before]     [ *   * ]     a is at location x
  * iload x      [ a   * ]
  * ldc k        [ a   k ]
@@ -531,6 +553,18 @@ int set_label(CODE *c, int l) {
     case ifneCK:
       c->val.ifneC = l;
       break;
+    case ifltCK:
+      c->val.ifltC = l;
+      break;
+    case ifgeCK:
+      c->val.ifgeC = l;
+      break;
+    case ifgtCK:
+      c->val.ifgtC = l;
+      break;
+    case ifleCK:
+      c->val.ifleC = l;
+      break;
     case if_acmpeqCK:
       c->val.if_acmpeqC = l;
       break;
@@ -834,6 +868,18 @@ int invert_comparison(CODE **c) {
     case ifneCK:
       l1 = (*c)->val.ifneC;
       break;
+    case ifltCK:
+      l1 = (*c)->val.ifltC;
+      break;
+    case ifgeCK:
+      l1 = (*c)->val.ifgeC;
+      break;
+    case ifgtCK:
+      l1 = (*c)->val.ifgtC;
+      break;
+    case ifleCK:
+      l1 = (*c)->val.ifleC;
+      break;
     case if_acmpeqCK:
       l1 = (*c)->val.if_acmpeqC;
       break;
@@ -883,6 +929,18 @@ int invert_comparison(CODE **c) {
       case ifneCK:
         new_code = makeCODEifeq(l2,NULL);
         break;
+      case ifltCK:
+        new_code = makeCODEifge(l2,NULL);
+        break;
+      case ifgeCK:
+        new_code = makeCODEiflt(l2,NULL);
+        break;
+      case ifgtCK:
+        new_code = makeCODEifle(l2,NULL);
+        break;
+      case ifleCK:
+        new_code = makeCODEifgt(l2,NULL);
+        break;
       case if_acmpeqCK:
         new_code = makeCODEif_acmpne(l2,NULL);
         break;
@@ -1003,9 +1061,9 @@ int remove_instruction_after_return(CODE **c) {
 
 
 /* iconst_0                     [ 0 ]
- * if_icmpeq/if_icmpne L1       [ * ]   and go to L1
+ * if_icmpeq/ne/lt/ge/gt/le L1  [ * ]   and go to L1
  * ---------->
- * ifeq/ifne L1                 [ * ]   and go to L1
+ * ifeq/ne/lt/ge/gt/le L1       [ * ]   and go to L1
  *
  * Instead of loading 0 and comparing, we can use the built-in instruction
  *
@@ -1021,6 +1079,14 @@ int simplify_icmp_0(CODE **c) {
       return replace(c, 2, makeCODEifeq(l, NULL));
     } else if (is_if_icmpne(next(*c), &l)) {
       return replace(c, 2, makeCODEifne(l, NULL));
+    } else if (is_if_icmplt(next(*c), &l)) {
+      return replace(c, 2, makeCODEiflt(l, NULL));
+    } else if (is_if_icmpge(next(*c), &l)) {
+      return replace(c, 2, makeCODEifge(l, NULL));
+    } else if (is_if_icmpgt(next(*c), &l)) {
+      return replace(c, 2, makeCODEifgt(l, NULL));
+    } else if (is_if_icmple(next(*c), &l)) {
+      return replace(c, 2, makeCODEifle(l, NULL));
     }
   }
   return 0;
@@ -1104,7 +1170,8 @@ int basic_unswap(CODE **c) {
  */
 int check_no_loads(CODE *c, int k, int *count) {
   int var;
-  int l;
+  int l, i;
+  SWITCH *s;
   (*count)--;
   if (*count == 0) return 0;
   if ((is_iload(c, &var)||is_aload(c,&var)) && var == k) return 0;
@@ -1115,6 +1182,13 @@ int check_no_loads(CODE *c, int k, int *count) {
 
   if (is_goto(c, &l)) return check_no_loads(destination(l), k, count);
 
+  if (is_switch(c, &s)) { /* never falls through */
+    for (i = 0; i < s->count; i++) {
+      if (!check_no_loads(destination(s->labels[i]), k, count)) return 0;
+    }
+    return check_no_loads(destination(s->defaultlabel), k, count);
+  }
+
   if (uses_label(c, &l)) { /* is comparison */
     return check_no_loads(next(c), k, count) &&
       check_no_loads(destination(l), k, count);
@@ -1123,16 +1197,21 @@ int check_no_loads(CODE *c, int k, int *count) {
 }
 
 /* 
- * istore/astore/iinc  k            (And k is not loaded afterwards)
+ * istore/astore  k            (And k is not loaded afterwards)
  * ...
  * ---------->
  * pop
  *
+ * iinc  k  d                  (And k is not loaded afterwards)
+ * ...
+ * ---------->
+ * nop
+ *
  *
  * If the current operation is a store, it searches through a fixed set of
  * paths to see if it is ever loaded. If all the branches terminate or have the
  * variable stored again, then we know the current load will never be used. It
- * is then safe to remove the store.
+ * is then safe to remove the store, popping the value it would have stored.
  *
  * Improvement:
  *      In the istore/astore case, does not increase bytecode size and
@@ -1143,10 +1222,14 @@ int remove_dead_store(CODE **c) {
   int k;
   int d; /* dummy */
   int instruction_count = N_LOOKAHEAD;
-  if ((is_istore(*c, &k) || is_astore(*c, &k) || is_iinc(*c, &k, &d))
+  if ((is_istore(*c, &k) || is_astore(*c, &k))
       && check_no_loads(next(*c), k, &instruction_count)) {
     return replace(c, 1, makeCODEpop(NULL));
   }
+  if (is_iinc(*c, &k, &d) /* pops nothing, so nothing is left to pop */
+      && check_no_loads(next(*c), k, &instruction_count)) {
+    return replace(c, 1, makeCODEnop(NULL));
+  }
   return 0;
 }
 
@@ -1236,6 +1319,27 @@ int basic_expression_pop(CODE **c) {
   return 0;
 }
 
+/* pure_expression_instruction      [ a b ]  (>= 1 byte)
+ * iadd/isub/imul                   [ c * ]  ( 1 byte)
+ * pop                              [ * * ]  ( 1 byte)
+ * ---------->
+ * pop                              [ * * ]  ( 1 byte)
+ *
+ * Left behind when the value of an arithmetic expression is dropped, for
+ * instance by a store to a field that is never read.
+ *
+ * Improvement:
+ *      Reduces bytecode size
+ */
+int binary_expression_pop(CODE **c) {
+  if (is_pure_expression_instruction(*c) &&
+      (is_iadd(next(*c)) || is_isub(next(*c)) || is_imul(next(*c))) &&
+      is_pop(next(next(*c)))) {
+    return replace(c, 3, makeCODEpop(NULL));
+  }
+  return 0;
+}
+
 
 
 /* Helper functions to check if two instructions are of a certain kind and are the same:
@@ -1277,6 +1381,10 @@ int instructions_equal_and_safe_to_factor(CODE *a, CODE *b) {
 
     check_and_compare_int(is_ifeq, a, b) ||
     check_and_compare_int(is_ifne, a, b) ||
+    check_and_compare_int(is_iflt, a, b) ||
+    check_and_compare_int(is_ifge, a, b) ||
+    check_and_compare_int(is_ifgt, a, b) ||
+    check_and_compare_int(is_ifle, a, b) ||
 
     check_and_compare_int(is_if_icmpeq, a, b) ||
     check_and_compare_int(is_if_icmpgt, a, b) ||
@@ -1491,11 +1599,13 @@ void init_patterns(void) {
   ADD_PATTERN(simplify_acmp_null);
   ADD_PATTERN(basic_unswap);
   ADD_PATTERN(dup_pop);
+  ADD_PATTERN(swap_swap);
   ADD_PATTERN(simplify_ldc_string_ifnonnull);
   ADD_PATTERN(remove_unnecessary_goto);
   ADD_PATTERN(simplify_concat_string_ifnonnull);
   ADD_PATTERN(remove_dead_store);
   ADD_PATTERN(basic_expression_pop);
+  ADD_PATTERN(binary_expression_pop);
   ADD_PATTERN(simplify_dup_ifeq_ifeq);
   ADD_PATTERN(simplify_dup_ifeq_ifne);
   ADD_PATTERN(simplify_iconst_goto_ifeq);
@@ -1511,5 +1621,6 @@ void init_patterns(void) {
   ADD_PATTERN(factor_instruction_risky);
   ADD_PATTERN(factor_instruction2_risky);
   */
+  ADD_PATTERN(superopt_rules);
   ADD_PATTERN(remove_nop);
 }
@@ -0,0 +1,557 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <string.h>
+#include <limits.h>
+#include "memory.h"
+#include "flow.h"
+#include "codeinfo.h"
+#include "optimize.h"
+#include "range.h"
+
+/* A value is an index into rangelo/rangehi, with 0 for any int and 1 for
+ * none, together with the local it was loaded from, if that still holds the
+ * same int.  A test of such a value narrows the local too; where it leaves
+ * no int the path cannot be taken.  Locals only hold an index.
+ */
+
+#define UNKNOWN 0
+#define EMPTY 1
+#define INDEX(v) ((v)&0xfffff)
+#define SOURCE(v) (((v)>>20)-1)
+#define MAKE(r,k) ((r)|(((k)+1)<<20))
+#define LO(v) rangelo[INDEX(v)]
+#define HI(v) rangehi[INDEX(v)]
+
+#define CHARMAX 65535
+
+int *rangelo, *rangehi;
+int rangecount, rangesize;
+
+int rangei2c, rangefolded, rangethreaded;
+
+int rangeAdd(int lo, int hi)
+{ int *l, *h;
+  int i;
+  if (rangecount==rangesize) {
+     rangesize = 2*rangesize+64;
+     l = Malloc(rangesize*sizeof(int));
+     h = Malloc(rangesize*sizeof(int));
+     for (i=0; i<rangecount; i++) {
+         l[i] = rangelo[i];
+         h[i] = rangehi[i];
+     }
+     rangelo = l;
+     rangehi = h;
+  }
+  rangelo[rangecount] = lo;
+  rangehi[rangecount] = hi;
+  return rangecount++;
+}
+
+int rangeIndex(double lo, double hi)
+{ int i;
+  if (lo>hi) return EMPTY;
+  if (lo<INT_MIN || hi>INT_MAX) return UNKNOWN;
+  for (i=0; i<rangecount; i++) {
+      if (rangelo[i]==lo && rangehi[i]==hi) return i;
+  }
+  return rangeAdd(lo,hi);
+}
+
+int rangeJoin(int a, int b)
+{ int k;
+  k = SOURCE(a)==SOURCE(b) ? SOURCE(a) : -1;
+  if (INDEX(a)==INDEX(b) || INDEX(b)==EMPTY) return MAKE(INDEX(a),k);
+  if (INDEX(a)==EMPTY) return MAKE(INDEX(b),k);
+  return MAKE(rangeIndex(LO(a)<LO(b) ? LO(a) : LO(b),HI(a)>HI(b) ? HI(a) : HI(b)),k);
+}
+
+/* A bound that grows at a loop head jumps to the next of a few thresholds,
+ * so the analysis of a loop terminates.  Every cycle goes through the
+ * target of a backward branch, and rangewidened holds the state last left
+ * by each such target.
+ */
+int rangethresholds[] = { INT_MIN, -CHARMAX, -1, 0, 1, 255, CHARMAX, INT_MAX };
+#define THRESHOLDS (sizeof(rangethresholds)/sizeof(int))
+
+int *rangewidened;
+
+int rangeWiden(int old, int v)
+{ int lo, hi, i;
+  if (INDEX(old)==EMPTY || INDEX(v)==EMPTY) return rangeJoin(v,old);
+  lo = LO(old);
+  hi = HI(old);
+  if (LO(v)<lo) {
+     for (i=THRESHOLDS-1; rangethresholds[i]>LO(v); i--);
+     lo = rangethresholds[i];
+  }
+  if (HI(v)>hi) {
+     for (i=0; rangethresholds[i]<HI(v); i++);
+     hi = rangethresholds[i];
+  }
+  return MAKE(rangeIndex(lo,hi),SOURCE(v));
+}
+
+void rangeLoopHead(FLOW *f, int i, int *s)
+{ int *w, k;
+  w = rangewidened+i*f->width;
+  if (FLOWHEIGHT(w)==-1) {
+     memcpy(w,s,f->width*sizeof(int));
+     return;
+  }
+  for (k=0; k<FLOWHEIGHT(s); k++) {
+      FLOWSTACK(f,w,k) = FLOWSTACK(f,s,k) = rangeWiden(FLOWSTACK(f,w,k),FLOWSTACK(f,s,k));
+  }
+  for (k=0; k<f->localslimit; k++) {
+      FLOWLOCAL(f,w,k) = FLOWLOCAL(f,s,k) = rangeWiden(FLOWLOCAL(f,w,k),FLOWLOCAL(f,s,k));
+  }
+}
+
+/* the range of the value an int, char or boolean descriptor d ends with */
+int rangeDescriptor(char *d)
+{ char t;
+  t = d[strlen(d)-1];
+  if (t=='C') return rangeIndex(0,CHARMAX);
+  if (t=='Z') return rangeIndex(0,1);
+  return UNKNOWN;
+}
+
+int rangeArithmetic(CODE *c, int x, int y)
+{ double a, b, p[4];
+  int i;
+  if (INDEX(x)==EMPTY || INDEX(y)==EMPTY) return EMPTY;
+  switch (c->kind) {
+    case iaddCK:
+         return rangeIndex((double)LO(x)+LO(y),(double)HI(x)+HI(y));
+    case isubCK:
+         return rangeIndex((double)LO(x)-HI(y),(double)HI(x)-LO(y));
+    case imulCK:
+         p[0] = (double)LO(x)*LO(y);
+         p[1] = (double)LO(x)*HI(y);
+         p[2] = (double)HI(x)*LO(y);
+         p[3] = (double)HI(x)*HI(y);
+         a = b = p[0];
+         for (i=1; i<4; i++) {
+             if (p[i]<a) a = p[i];
+             if (p[i]>b) b = p[i];
+         }
+         return rangeIndex(a,b);
+    case idivCK:
+         if (LO(y)!=HI(y) || LO(y)<=0) return UNKNOWN;
+         return rangeIndex(LO(x)/LO(y),HI(x)/LO(y));
+    case iremCK:
+         /* the result has the sign of x and is smaller than |y| */
+         if (LO(y)!=HI(y) || LO(y)==0 || LO(y)==INT_MIN) return UNKNOWN;
+         a = LO(y)<0 ? -(double)LO(y)-1 : LO(y)-1;
+         if (LO(x)>=0) return rangeIndex(0,HI(x)<a ? HI(x) : a);
+         if (HI(x)<=0) return rangeIndex(LO(x)>-a ? LO(x) : -a,0);
+         return rangeIndex(-a,a);
+    default:
+         return UNKNOWN;
+  }
+}
+
+/* narrows local k, and its copies on the stack, to lo..hi */
+void rangeRefine(FLOW *f, int *s, int k, double lo, double hi)
+{ int j, r;
+  if (k==-1) return;
+  if (LO(FLOWLOCAL(f,s,k))>lo) lo = LO(FLOWLOCAL(f,s,k));
+  if (HI(FLOWLOCAL(f,s,k))<hi) hi = HI(FLOWLOCAL(f,s,k));
+  r = rangeIndex(lo,hi);
+  FLOWLOCAL(f,s,k) = r;
+  for (j=0; j<FLOWHEIGHT(s); j++) {
+      if (SOURCE(FLOWSTACK(f,s,j))==k) FLOWSTACK(f,s,j) = MAKE(r,k);
+  }
+}
+
+void rangeKill(FLOW *f, int *s, int k)
+{ int j;
+  for (j=0; j<FLOWHEIGHT(s); j++) {
+      if (SOURCE(FLOWSTACK(f,s,j))==k) {
+         FLOWSTACK(f,s,j) = MAKE(INDEX(FLOWSTACK(f,s,j)),-1);
+      }
+  }
+}
+
+/* narrows x and y in s knowing that "x op y" holds, where op is the
+ * comparison of an if_icmp kind
+ */
+void rangeAssume(FLOW *f, int *s, int kind, int x, int y)
+{ switch (kind) {
+    case if_icmpeqCK:
+         rangeRefine(f,s,SOURCE(x),LO(y),HI(y));
+         rangeRefine(f,s,SOURCE(y),LO(x),HI(x));
+         break;
+    case if_icmpneCK:
+         if (LO(y)==HI(y) && LO(x)==LO(y)) rangeRefine(f,s,SOURCE(x),(double)LO(x)+1,HI(x));
+         if (LO(y)==HI(y) && HI(x)==LO(y)) rangeRefine(f,s,SOURCE(x),LO(x),(double)HI(x)-1);
+         if (LO(x)==HI(x) && LO(y)==LO(x)) rangeRefine(f,s,SOURCE(y),(double)LO(y)+1,HI(y));
+         if (LO(x)==HI(x) && HI(y)==LO(x)) rangeRefine(f,s,SOURCE(y),LO(y),(double)HI(y)-1);
+         break;
+    case if_icmpltCK:
+         rangeRefine(f,s,SOURCE(x),INT_MIN,(double)HI(y)-1);
+         rangeRefine(f,s,SOURCE(y),(double)LO(x)+1,INT_MAX);
+         break;
+    case if_icmpleCK:
+         rangeRefine(f,s,SOURCE(x),INT_MIN,HI(y));
+         rangeRefine(f,s,SOURCE(y),LO(x),INT_MAX);
+         break;
+    case if_icmpgtCK:
+         rangeAssume(f,s,if_icmpltCK,y,x);
+         break;
+    case if_icmpgeCK:
+         rangeAssume(f,s,if_icmpleCK,y,x);
+         break;
+    default:
+         break;
+  }
+}
+
+int rangeNegate(int kind)
+{ switch (kind) {
+    case if_icmpeqCK: return if_icmpneCK;
+    case if_icmpneCK: return if_icmpeqCK;
+    case if_icmpltCK: return if_icmpgeCK;
+    case if_icmpleCK: return if_icmpgtCK;
+    case if_icmpgtCK: return if_icmpleCK;
+    case if_icmpgeCK: return if_icmpltCK;
+    default: return kind;
+  }
+}
+
+/* the if_icmp kind that compares with zero as kind does */
+int rangeWithZero(int kind)
+{ switch (kind) {
+    case ifeqCK: return if_icmpeqCK;
+    case ifneCK: return if_icmpneCK;
+    case ifltCK: return if_icmpltCK;
+    case ifgeCK: return if_icmpgeCK;
+    case ifgtCK: return if_icmpgtCK;
+    case ifleCK: return if_icmpleCK;
+    default: return kind;
+  }
+}
+
+void rangeTransfer(FLOW *f, int i, int *fall, int *taken)
+{ CODE *c;
+  int h, x, y, k, zero;
+  c = f->code[i];
+  if (FLOWHEIGHT(rangewidened+i*f->width)!=-2) rangeLoopHead(f,i,fall);
+  h = FLOWHEIGHT(fall);
+  x = h>1 ? FLOWTOP(f,fall,2) : UNKNOWN;
+  y = h>0 ? FLOWTOP(f,fall,1) : UNKNOWN;
+  switch (c->kind) {
+    case ldc_intCK:
+         FLOWSTACK(f,fall,h) = rangeIndex(c->val.ldc_intC,c->val.ldc_intC);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case iloadCK:
+         k = c->val.iloadC;
+         FLOWSTACK(f,fall,h) = MAKE(INDEX(FLOWLOCAL(f,fall,k)),k);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case istoreCK:
+    case astoreCK:
+         k = codeinfoInt(c);
+         rangeKill(f,fall,k);
+         FLOWLOCAL(f,fall,k) = INDEX(y);
+         FLOWHEIGHT(fall) = h-1;
+         break;
+    case iincCK:
+         k = c->val.iincC.offset;
+         rangeKill(f,fall,k);
+         FLOWLOCAL(f,fall,k) = rangeIndex((double)LO(FLOWLOCAL(f,fall,k))+c->val.iincC.amount,
+                                          (double)HI(FLOWLOCAL(f,fall,k))+c->val.iincC.amount);
+         break;
+    case iaddCK:
+    case isubCK:
+    case imulCK:
+    case idivCK:
+    case iremCK:
+         FLOWTOP(f,fall,2) = rangeArithmetic(c,x,y);
+         FLOWHEIGHT(fall) = h-1;
+         break;
+    case inegCK:
+         FLOWTOP(f,fall,1) = rangeIndex(-(double)HI(y),-(double)LO(y));
+         break;
+    case i2cCK:
+         if (LO(y)<0 || HI(y)>CHARMAX) FLOWTOP(f,fall,1) = rangeIndex(0,CHARMAX);
+         break;
+    case instanceofCK:
+         FLOWTOP(f,fall,1) = rangeIndex(0,1);
+         break;
+    case getfieldCK:
+    case invokevirtualCK:
+    case invokenonvirtualCK:
+         flowDefault(f,i,fall,UNKNOWN);
+         if (codeinfoPushes(c)) FLOWTOP(f,fall,1) = rangeDescriptor(codeinfoString(c));
+         break;
+    default:
+         flowDefault(f,i,fall,UNKNOWN);
+         break;
+  }
+  memcpy(taken,fall,f->width*sizeof(int));
+  switch (c->kind) {
+    case ifeqCK:
+    case ifneCK:
+    case ifltCK:
+    case ifgeCK:
+    case ifgtCK:
+    case ifleCK:
+         zero = rangeIndex(0,0);
+         rangeAssume(f,taken,rangeWithZero(c->kind),y,zero);
+         rangeAssume(f,fall,rangeNegate(rangeWithZero(c->kind)),y,zero);
+         break;
+    case if_icmpeqCK:
+    case if_icmpneCK:
+    case if_icmpltCK:
+    case if_icmpleCK:
+    case if_icmpgtCK:
+    case if_icmpgeCK:
+         rangeAssume(f,taken,c->kind,x,y);
+         rangeAssume(f,fall,rangeNegate(c->kind),x,y);
+         break;
+    default:
+         break;
+  }
+}
+
+/* 1 if "x op y" always holds, 0 if it never does, -1 if not known */
+int rangeDecide(int kind, int x, int y)
+{ switch (kind) {
+    case if_icmpeqCK:
+         if (LO(x)==HI(x) && LO(y)==HI(y) && LO(x)==LO(y)) return 1;
+         if (HI(x)<LO(y) || HI(y)<LO(x)) return 0;
+         return -1;
+    case if_icmpltCK:
+         if (HI(x)<LO(y)) return 1;
+         if (LO(x)>=HI(y)) return 0;
+         return -1;
+    case if_icmpleCK:
+         if (HI(x)<=LO(y)) return 1;
+         if (LO(x)>HI(y)) return 0;
+         return -1;
+    case if_icmpneCK:
+    case if_icmpgtCK:
+    case if_icmpgeCK:
+         kind = rangeDecide(rangeNegate(kind),x,y);
+         return kind==-1 ? -1 : !kind;
+    default:
+         return -1;
+  }
+}
+
+/* the outcome of the test c in state s as rangeDecide gives it */
+int rangeOutcome(FLOW *f, CODE *c, int *s)
+{ switch (c->kind) {
+    case ifeqCK:
+    case ifneCK:
+    case ifltCK:
+    case ifgeCK:
+    case ifgtCK:
+    case ifleCK:
+         return rangeDecide(rangeWithZero(c->kind),FLOWTOP(f,s,1),rangeIndex(0,0));
+    case if_icmpeqCK:
+    case if_icmpneCK:
+    case if_icmpltCK:
+    case if_icmpleCK:
+    case if_icmpgtCK:
+    case if_icmpgeCK:
+         return rangeDecide(c->kind,FLOWTOP(f,s,2),FLOWTOP(f,s,1));
+    default:
+         return -1;
+  }
+}
+
+/* Jump threading: a goto or branch to a test whose outcome the state on
+ * that one edge decides, as in
+ *
+ *   iconst_0              iload k
+ *   goto L                ifeq L
+ *   ...                   ...
+ *   L:                    L:
+ *   dup                   iload k
+ *   ifeq M                ifne M
+ *
+ * jumps past the test instead.  The pure instructions between the label and
+ * the test are copied onto the edge, followed by pops of the tested values;
+ * a pop then cancels a push just before it, or, for a goto, one just before
+ * the goto.  Edges whose copy would not cancel out within RANGEBUDGET bytes
+ * are left alone, and a branch takes no copy at all.
+ */
+
+#define RANGEPREFIX 4
+#define RANGEBUDGET 0
+
+int rangeIsPush(CODE *c)
+{ return (codeinfo[c->kind].flags&CIPUSH) && codeinfoPops(c)==0;
+}
+
+int rangeThreadEdge(FLOW *f, int i, int *edge, int *after)
+{ CODE *seq[RANGEPREFIX+2], *g, *t, *r;
+  int *s, n, j, k, p, d, label, growth;
+
+  g = f->code[i];
+  s = Malloc(f->width*sizeof(int));
+  memcpy(s,edge,f->width*sizeof(int));
+  n = 0;
+  for (j=f->target[i]; j<f->count; j++) {
+      t = f->code[j];
+      if (t->kind==labelCK || t->kind==nopCK) continue;
+      if (!(codeinfo[t->kind].flags&CIPURE) || (codeinfo[t->kind].flags&CIBRANCH) ||
+          n==RANGEPREFIX) break;
+      seq[n++] = t;
+      rangeTransfer(f,j,s,Malloc(f->width*sizeof(int)));
+  }
+  if (j>=f->count || j==i || !(codeinfo[f->code[j]->kind].flags&CICONDITIONAL)) {
+     return 0;
+  }
+  d = rangeOutcome(f,f->code[j],s);
+  if (d==-1) return 0;
+  for (k=codeinfoPops(f->code[j]); k>0; k--) seq[n++] = makeCODEpop(NULL);
+
+  /* a push or dup followed by a pop on the edge cancels out */
+  for (k=0; k+1<n; k++) {
+      if (seq[k+1]->kind!=popCK ||
+          (!rangeIsPush(seq[k]) && seq[k]->kind!=dupCK)) continue;
+      for (p=k; p+2<n; p++) seq[p] = seq[p+2];
+      n -= 2;
+      k = k>0 ? k-2 : -1;
+  }
+  growth = 0;
+  for (k=0; k<n; k++) growth += codeinfoSize(seq[k]);
+  for (k=0, p=i-1; g->kind==gotoCK && k<n && seq[k]->kind==popCK; k++, p--) {
+      while (p>=0 && f->code[p]->kind==nopCK) p--;
+      if (p<0 || !rangeIsPush(f->code[p]) || f->height[p]==-1) break;
+      growth -= codeinfoSize(f->code[p])+1;
+  }
+  if (growth>RANGEBUDGET || (g->kind!=gotoCK && n>0)) return 0;
+
+  if (d) {
+     label = codeinfoInt(f->code[j]);
+  } else if (after[j]!=-1) {
+     label = after[j];
+  } else if (j+1<f->count && f->code[j+1]->kind==labelCK) {
+     label = after[j] = codeinfoInt(f->code[j+1]);
+  } else {
+     label = after[j] = next_label();
+     t = makeCODElabel(label,f->code[j]->next);
+     INSERTnewlabel(label,"threaded",t,0);
+     f->code[j]->next = t;
+  }
+  droplabel(codeinfoInt(g));
+  codeinfoSetInt(g,copylabel(label));
+
+  /* the pops that cancel a push before the goto come first in seq */
+  for (p=i-1; k>0; k--, p--) {
+      while (f->code[p]->kind==nopCK) p--;
+      f->code[p]->kind = nopCK;
+      for (j=0; j+1<n; j++) seq[j] = seq[j+1];
+      n--;
+  }
+  if (n>0) {
+     r = makeCODEgoto(label,g->next);
+     for (k=n-1; k>=0; k--) {
+         t = NEW(CODE);
+         *t = *seq[k];
+         t->next = r;
+         r = t;
+     }
+     *g = *r;
+  }
+  rangethreaded++;
+  return 1;
+}
+
+/* threads every goto and branch it can, using the states of the solved f */
+int rangeThread(FLOW *f)
+{ int *fall, *taken, *after;
+  int i, change;
+  CODE *g;
+  fall = Malloc(f->width*sizeof(int));
+  taken = Malloc(f->width*sizeof(int));
+  after = Malloc((f->count+1)*sizeof(int));
+  for (i=0; i<f->count; i++) after[i] = -1;
+  change = 0;
+  for (i=0; i<f->count; i++) {
+      g = f->code[i];
+      if (f->target[i]==-1 || flowIn(f,i)==NULL ||
+          (g->kind!=gotoCK && !(codeinfo[g->kind].flags&CICONDITIONAL))) continue;
+      memcpy(fall,flowIn(f,i),f->width*sizeof(int));
+      rangeTransfer(f,i,fall,taken);
+      if (rangeThreadEdge(f,i,taken,after)) change = 1;
+  }
+  return change;
+}
+
+/* Deletes i2c on values in char range and replaces tests with a known
+ * outcome by pops and, if taken, a goto.  When neither applies, the jumps
+ * are threaded instead.
+ */
+int rangeCODE(CODE *c, FORMAL *formals, int localslimit)
+{ FLOW *f;
+  FORMAL *p;
+  CODE *g, *r;
+  int *s, i, k, d, label, change;
+
+  rangecount = 0;
+  rangeAdd(INT_MIN,INT_MAX);
+  rangeAdd(1,0);
+  f = flowCODE(c,localslimit);
+  /* a height of -2 marks the instructions that are not loop heads,
+   * -1 the loop heads not reached yet
+   */
+  rangewidened = Malloc((f->count+1)*f->width*sizeof(int));
+  for (i=0; i<f->count; i++) FLOWHEIGHT(rangewidened+i*f->width) = -2;
+  for (i=0; i<f->count; i++) {
+      if (f->target[i]!=-1 && f->target[i]<=i) {
+         FLOWHEIGHT(rangewidened+f->target[i]*f->width) = -1;
+      }
+  }
+  s = flowEntry(f,UNKNOWN);
+  for (p=formals; p!=NULL; p=p->next) {
+      if (p->offset>=localslimit) continue;
+      if (p->type->kind==charK) FLOWLOCAL(f,s,p->offset) = rangeIndex(0,CHARMAX);
+      if (p->type->kind==boolK) FLOWLOCAL(f,s,p->offset) = rangeIndex(0,1);
+  }
+  flowSolve(f,s,rangeJoin,rangeTransfer);
+
+  change = 0;
+  for (i=0; i<f->count; i++) {
+      s = flowIn(f,i);
+      g = f->code[i];
+      if (s==NULL) continue;
+      if (g->kind==i2cCK) {
+         if (LO(FLOWTOP(f,s,1))>=0 && HI(FLOWTOP(f,s,1))<=CHARMAX) {
+            g->kind = nopCK;
+            rangei2c++;
+            change = 1;
+         }
+         continue;
+      }
+      d = rangeOutcome(f,g,s);
+      if (d==-1) continue;
+      label = codeinfoInt(g);
+      if (d) {
+         r = makeCODEgoto(label,g->next);
+      } else {
+         droplabel(label);
+         r = g->next;
+      }
+      for (k=codeinfoPops(g); k>0; k--) r = makeCODEpop(r);
+      *g = *r;
+      rangefolded++;
+      change = 1;
+  }
+  return change || rangeThread(f);
+}
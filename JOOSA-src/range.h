@@ -0,0 +1,23 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Integer range analysis: an interval for every int on the stack and in
+ * the locals, used to delete i2c on values that are already chars, to fold
+ * tests whose outcome the intervals decide and to thread jumps to tests
+ * that the intervals on the jump alone decide.
+ */
+
+extern int rangei2c, rangefolded, rangethreaded;
+
+int rangeCODE(CODE *c, FORMAL *formals, int localslimit);
@@ -0,0 +1,237 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "symbol.h"
+#include "codeinfo.h"
+#include "cha.h"
+#include "optimize.h"
+#include "reach.h"
+
+/* values of reachable */
+#define UNREACHED 0
+#define REACHED 1     /* but its code is not scanned yet */
+#define SCANNED 2
+
+int reachchange;
+int reachmethods, reachconstructors, reachclasses;
+
+void reachMark(int *reachable)
+{ if (*reachable==UNREACHED) {
+     *reachable = REACHED;
+     reachchange = 1;
+  }
+}
+
+/* the method that a call of name on class resolves to, which must stay
+ * even when it is abstract
+ */
+void reachMethod(CLASS *c, char *name)
+{ SYMBOL *s;
+  CLASS *owner;
+  s = lookupHierarchy(name,c);
+  owner = lookupHierarchyClass(name,c);
+  if (s==NULL || s->kind!=methodSym || owner==NULL || owner->external) return;
+  reachMark(&s->val.methodS->reachable);
+}
+
+void reachConstructor(CLASS *c, char *signature)
+{ CONSTRUCTOR *k;
+  if (c->external) return;
+  for (k=c->constructors; k!=NULL; k=k->next) {
+      if (strcmp(k->signature,signature)==0) reachMark(&k->reachable);
+  }
+}
+
+void reachCODE(CODE *c)
+{ CLASS *class;
+  IMPLEMENTATION *i;
+  char *name;
+  for (; c!=NULL; c=c->next) {
+      switch (c->kind) {
+        case invokevirtualCK:
+             if (!chaSplit(c->val.invokevirtualC,&class,&name)) break;
+             reachMethod(class,name);
+             for (i=chaImplementations(name); i!=NULL; i=i->next) {
+                 if (subClass(i->class,class)) reachMark(&i->method->reachable);
+             }
+             break;
+        case invokenonvirtualCK:
+             if (!chaSplit(c->val.invokenonvirtualC,&class,&name)) break;
+             if (strcmp(name,"<init>")==0) {
+                reachConstructor(class,strchr(c->val.invokenonvirtualC,'('));
+             } else {
+                reachMethod(class,name);
+             }
+             break;
+        default:
+             break;
+      }
+  }
+}
+
+/* 1 if m overrides a method of a library class, even through a method of
+ * a class in between, as B.toString does in "class A { toString() }" and
+ * "class B extends A { toString() }"
+ */
+int reachOverridesExternal(CLASS *c, METHOD *m)
+{ CLASS *owner;
+  owner = c;
+  while (owner->parent!=NULL) {
+    owner = lookupHierarchyClass(m->name,owner->parent);
+    if (owner==NULL) return 0;
+    if (owner->external) return 1;
+  }
+  return 0;
+}
+
+/* 1 if s, the operand of a new, checkcast, instanceof, field access or
+ * call, or a descriptor, names the class whose internal name is name
+ */
+int reachMentions(char *s, char *name)
+{ char *p;
+  int n;
+  n = strlen(name);
+  if (strncmp(s,name,n)==0 && (s[n]=='\0' || s[n]=='/')) return 1;
+  for (p=strchr(s,'L'); p!=NULL; p=strchr(p+1,'L')) {
+      if (strncmp(p+1,name,n)==0 && p[n+1]==';') return 1;
+  }
+  return 0;
+}
+
+int reachMentionedIn(CODE *c, char *name)
+{ for (; c!=NULL; c=c->next) {
+      if (codeinfo[c->kind].operand!=CISTRING || c->kind==ldc_stringCK) continue;
+      if (reachMentions(codeinfoString(c),name)) return 1;
+  }
+  return 0;
+}
+
+/* 1 if the members of c that are still there, or a class in p that
+ * remains, need c
+ */
+int reachClassNeeded(PROGRAM *p, CLASS *c)
+{ PROGRAM *q;
+  CLASSFILE *f;
+  CONSTRUCTOR *k;
+  METHOD *m;
+  FIELD *d;
+  if (c->constructors!=NULL || c->methods!=NULL) return 1;
+  for (q=p; q!=NULL; q=q->next) {
+      for (f=q->classfile; f!=NULL; f=f->next) {
+          if (f->class==c || f->class->external) continue;
+          if (f->class->parent==c) return 1;
+          for (d=f->class->fields; d!=NULL; d=d->next) {
+              if (d->type->kind==refK && d->type->class==c) return 1;
+          }
+          for (k=f->class->constructors; k!=NULL; k=k->next) {
+              if (reachMentions(k->signature,c->signature) ||
+                  reachMentionedIn(k->opcodes,c->signature)) return 1;
+          }
+          for (m=f->class->methods; m!=NULL; m=m->next) {
+              if (reachMentions(m->signature,c->signature) ||
+                  reachMentionedIn(m->opcodes,c->signature)) return 1;
+          }
+      }
+  }
+  return 0;
+}
+
+void reachPROGRAM(PROGRAM *p)
+{ PROGRAM *q;
+  CLASSFILE *f, **pf;
+  CONSTRUCTOR *k, **pk;
+  METHOD *m, **pm;
+  int change;
+
+  chaBuildPROGRAM(p);
+  reachmethods = reachconstructors = reachclasses = 0;
+  for (q=p; q!=NULL; q=q->next) {
+      for (f=q->classfile; f!=NULL; f=f->next) {
+          if (f->class->external) continue;
+          for (m=f->class->methods; m!=NULL; m=m->next) {
+              if (m->modifier==staticMod || reachOverridesExternal(f->class,m)) {
+                 m->reachable = REACHED;
+              }
+          }
+      }
+  }
+
+  reachchange = 1;
+  while (reachchange) {
+    reachchange = 0;
+    for (q=p; q!=NULL; q=q->next) {
+        for (f=q->classfile; f!=NULL; f=f->next) {
+            if (f->class->external) continue;
+            for (k=f->class->constructors; k!=NULL; k=k->next) {
+                if (k->reachable!=REACHED) continue;
+                k->reachable = SCANNED;
+                reachCODE(k->opcodes);
+            }
+            for (m=f->class->methods; m!=NULL; m=m->next) {
+                if (m->reachable!=REACHED) continue;
+                m->reachable = SCANNED;
+                reachCODE(m->opcodes);
+            }
+        }
+    }
+  }
+
+  for (q=p; q!=NULL; q=q->next) {
+      for (f=q->classfile; f!=NULL; f=f->next) {
+          if (f->class->external) continue;
+          for (pk=&f->class->constructors; *pk!=NULL;) {
+              if ((*pk)->reachable || !optiAllowed()) {
+                 pk = &(*pk)->next;
+              } else {
+                 optiName(f->class->name,"<init>");
+                 optiRewrite("reachPROGRAM",NULL);
+                 *pk = (*pk)->next;
+                 reachconstructors++;
+              }
+          }
+          for (pm=&f->class->methods; *pm!=NULL;) {
+              if ((*pm)->reachable || !optiAllowed()) {
+                 pm = &(*pm)->next;
+              } else {
+                 optiName(f->class->name,(*pm)->name);
+                 optiRewrite("reachPROGRAM",NULL);
+                 *pm = (*pm)->next;
+                 reachmethods++;
+              }
+          }
+      }
+  }
+
+  /* removing a class can make its parent unneeded */
+  do {
+    change = 0;
+    for (q=p; q!=NULL; q=q->next) {
+        for (pf=&q->classfile; *pf!=NULL;) {
+            if ((*pf)->class->external || !optiAllowed() ||
+                reachClassNeeded(p,(*pf)->class)) {
+               pf = &(*pf)->next;
+            } else {
+               optiName((*pf)->class->name,NULL);
+               optiRewrite("reachPROGRAM",NULL);
+               *pf = (*pf)->next;
+               reachclasses++;
+               change = 1;
+            }
+        }
+    }
+  } while (change);
+
+  printf("\nunreachable methods removed: %i, constructors: %i, classes: %i\n",
+         reachmethods,reachconstructors,reachclasses);
+}
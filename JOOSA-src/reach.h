@@ -0,0 +1,23 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Whole-program reachability.  Starting from every static main and every
+ * method that overrides a library method, which the library may call back,
+ * it follows the calls in the code: a virtual call reaches every
+ * implementation class hierarchy analysis allows.  Methods and constructors
+ * that are never reached are removed, and so are classes that no remaining
+ * code or signature mentions.
+ */
+
+void reachPROGRAM(PROGRAM *p);
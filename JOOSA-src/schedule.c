@@ -0,0 +1,112 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "optimize.h"
+#include "flow.h"
+#include "schedule.h"
+
+int schedulepairs;
+
+/* returns the local that c loads from, stores to or increments, or -1 */
+int scheduleLocal(CODE *c)
+{ switch (c->kind) {
+    case iloadCK:
+         return c->val.iloadC;
+    case aloadCK:
+         return c->val.aloadC;
+    case istoreCK:
+         return c->val.istoreC;
+    case astoreCK:
+         return c->val.astoreC;
+    case iincCK:
+         return c->val.iincC.offset;
+    default:
+         return -1;
+  }
+}
+
+int scheduleIsLoad(CODE *store, CODE *c, int x)
+{ if (store->kind==istoreCK) return c->kind==iloadCK && c->val.iloadC==x;
+  return c->kind==aloadCK && c->val.aloadC==x;
+}
+
+/* The def-use pair
+ *
+ *   xstore x        [ .. v ]
+ *   I               [ .. ]       I never reaches below the dotted part
+ *   xload x         [ .. w* ]    w* is zero or one value left by I
+ *
+ * within one basic block, with x dead after the load, becomes
+ *
+ *   I               [ .. v w* ]
+ *   swap            [ .. w* v ]  only when I left one value
+ *
+ * The JVM has no general rotate, so values left deeper than that keep
+ * going through the local.  A swap that lands right next to another one
+ * is cancelled by the swap_swap pattern.
+ */
+int scheduleCODE(CODE *c, int localslimit)
+{ FLOW *f;
+  char *use, *def, *live;
+  int p, q, j, x, d, inc, affected, used, change;
+
+  f = flowCODE(c,localslimit);
+  change = 0;
+  for (x=0; x<localslimit; x++) {
+      use = Malloc(f->count+1);
+      def = Malloc(f->count+1);
+      for (j=0; j<f->count; j++) {
+          use[j] = def[j] = 0;
+          if (scheduleLocal(f->code[j])!=x) continue;
+          switch (f->code[j]->kind) {
+            case iloadCK:
+            case aloadCK:
+            case iincCK:
+                 use[j] = 1;
+                 break;
+            default:
+                 def[j] = 1;
+                 break;
+          }
+      }
+      live = flowLive(f,use,def);
+      for (p=0; p<f->count; p++) {
+          if (!def[p] || f->code[p]->kind==iincCK || f->height[p]==-1) continue;
+          d = 0;
+          for (q=p+1; q<f->count; q++) {
+              if (scheduleIsLoad(f->code[p],f->code[q],x)) break;
+              if (scheduleLocal(f->code[q])==x ||
+                  f->code[q]->kind==labelCK ||
+                  f->target[q]!=-1 || !flowFallsThrough(f->code[q])) {
+                 q = f->count;
+                 break;
+              }
+              stack_effect(f->code[q],&inc,&affected,&used);
+              if (d+used<0) {
+                 q = f->count;
+                 break;
+              }
+              d += inc;
+          }
+          if (q>=f->count || live[q] || d>1) continue;
+          f->code[p]->kind = nopCK;
+          f->code[q]->kind = d==0 ? nopCK : swapCK;
+          schedulepairs++;
+          change = 1;
+          p = q;
+      }
+  }
+  return change;
+}
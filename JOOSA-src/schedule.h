@@ -0,0 +1,21 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Stack scheduling within basic blocks, after Koopman: a value stored in a
+ * local and read back once later in the same block stays on the stack.
+ */
+
+extern int schedulepairs;
+
+int scheduleCODE(CODE *c, int localslimit);
@@ -0,0 +1,1487 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "flow.h"
+#include "codeinfo.h"
+#include "optimize.h"
+#include "ssa.h"
+#include "ssaopt.h"
+
+int ssamethods;
+
+int ssaValue(SSA *s, int type, SSAINSTR *def)
+{ int *types, *formals, *locals, k;
+  SSAINSTR **defs;
+  if (s->valuec==s->valuemax) {
+     s->valuemax *= 2;
+     types = Malloc(s->valuemax*sizeof(int));
+     defs = Malloc(s->valuemax*sizeof(SSAINSTR *));
+     formals = Malloc(s->valuemax*sizeof(int));
+     locals = Malloc(s->valuemax*sizeof(int));
+     for (k=0; k<s->valuec; k++) {
+         types[k] = s->type[k];
+         defs[k] = s->def[k];
+         formals[k] = s->formal[k];
+         locals[k] = s->local[k];
+     }
+     s->type = types;
+     s->def = defs;
+     s->formal = formals;
+     s->local = locals;
+  }
+  s->type[s->valuec] = type;
+  s->def[s->valuec] = def;
+  s->formal[s->valuec] = -1;
+  s->local[s->valuec] = -1;
+  return s->valuec++;
+}
+
+SSAINSTR *ssaInstr(int kind, CODE *code, int argc, int block)
+{ SSAINSTR *i;
+  i = NEW(SSAINSTR);
+  i->kind = kind;
+  i->code = code;
+  i->result = -1;
+  i->argc = argc;
+  i->args = Malloc((argc+1)*sizeof(int));
+  i->carried = 0;
+  i->block = block;
+  i->next = NULL;
+  return i;
+}
+
+/* the type of the value c pushes */
+int ssaType(CODE *c)
+{ char *d;
+  switch (c->kind) {
+    case ldc_stringCK:
+    case aconst_nullCK:
+    case newCK:
+    case checkcastCK:
+         return SSAREF;
+    case getfieldCK:
+         d = strchr(c->val.getfieldC,' ')+1;
+         break;
+    case invokevirtualCK:
+    case invokenonvirtualCK:
+         d = strchr(codeinfoString(c),')')+1;
+         break;
+    default:
+         return codeinfoPushes(c) ? SSAINT : SSANONE;
+  }
+  if (*d=='V') return SSANONE;
+  return *d=='L' || *d=='[' ? SSAREF : SSAINT;
+}
+
+int ssaIsInit(CODE *c)
+{ return c!=NULL && c->kind==invokenonvirtualCK &&
+         strstr(c->val.invokenonvirtualC,"/<init>")!=NULL;
+}
+
+int *ssaCopyInts(int *a, int n)
+{ int *b, k;
+  b = Malloc((n+1)*sizeof(int));
+  for (k=0; k<n; k++) b[k] = a[k];
+  return b;
+}
+
+/* Splits the reachable code into blocks and links them.  Returns 0 for
+ * code the form does not cover.
+ */
+int ssaBlocks(SSA *s, int *blockof)
+{ FLOW *f;
+  SSABLOCK *b;
+  int i, j, k, lead;
+  f = s->flow;
+  s->blockc = 1;
+  for (i=0; i<f->count; i++) {
+      blockof[i] = -1;
+      if (f->height[i]==-1) continue;
+      if (codeinfo[f->code[i]->kind].operand==CISWITCH) return 0;
+      lead = i==0 || f->height[i-1]==-1 ||
+             (codeinfo[f->code[i-1]->kind].flags&(CIBRANCH|CITERMINATOR)) ||
+             (f->code[i]->kind==labelCK && f->code[i-1]->kind!=labelCK);
+      if (lead) s->blockc++;
+      blockof[i] = s->blockc-1;
+  }
+  s->blocks = Malloc(s->blockc*sizeof(SSABLOCK));
+  for (j=0; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      b->start = b->end = 0;
+      b->phis = b->first = NULL;
+      b->predc = b->succc = 0;
+      b->succs = Malloc(2*sizeof(int));
+      b->fall = b->target = -1;
+      b->idom = -1;
+      b->live = 1;
+  }
+  for (i=0; i<f->count; i++) {
+      if (blockof[i]==-1) continue;
+      b = &s->blocks[blockof[i]];
+      if (i==0 || blockof[i-1]!=blockof[i]) b->start = i;
+      b->end = i+1;
+  }
+
+  s->blocks[0].fall = 1;
+  s->blocks[0].succs[s->blocks[0].succc++] = 1;
+  for (j=1; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      i = b->end-1;
+      if (flowFallsThrough(f->code[i])) {
+         if (i+1>=f->count || blockof[i+1]==-1) return 0;
+         b->fall = blockof[i+1];
+         b->succs[b->succc++] = b->fall;
+      }
+      if (codeinfo[f->code[i]->kind].flags&CIBRANCH) {
+         if (f->target[i]==-1 || blockof[f->target[i]]==-1) return 0;
+         b->target = blockof[f->target[i]];
+         if (b->target!=b->fall) b->succs[b->succc++] = b->target;
+      }
+  }
+
+  for (j=0; j<s->blockc; j++) {
+      for (k=0; k<s->blocks[j].succc; k++) s->blocks[s->blocks[j].succs[k]].predc++;
+  }
+  for (j=0; j<s->blockc; j++) {
+      s->blocks[j].preds = Malloc((s->blocks[j].predc+1)*sizeof(int));
+      s->blocks[j].predc = 0;
+  }
+  for (j=0; j<s->blockc; j++) {
+      for (k=0; k<s->blocks[j].succc; k++) {
+          b = &s->blocks[s->blocks[j].succs[k]];
+          b->preds[b->predc++] = j;
+      }
+  }
+  return 1;
+}
+
+/* Renames the instructions of block j, whose phis define the locals and
+ * the stack on entry, and leaves the locals and stack on exit in locals
+ * and stack.  Returns the stack height on exit, or -1 for code the form
+ * does not cover.
+ */
+int ssaRename(SSA *s, int j, int *locals, int *stack, int isstatic)
+{ FLOW *f;
+  SSABLOCK *b;
+  SSAINSTR *i, *k, **tail;
+  CODE *c;
+  int n, x, v, sp, pops, carried, recv;
+  f = s->flow;
+  b = &s->blocks[j];
+  sp = f->height[b->start];
+  tail = &b->phis;
+  for (x=0; x<f->localslimit; x++) {
+      i = ssaInstr(SSAPHI,NULL,b->predc,j);
+      i->result = ssaValue(s,SSANONE,i);
+      s->local[i->result] = x;
+      locals[x] = i->result;
+      *tail = i;
+      tail = &i->next;
+  }
+  for (x=0; x<sp; x++) {
+      i = ssaInstr(SSAPHI,NULL,b->predc,j);
+      i->result = ssaValue(s,SSANONE,i);
+      i->carried = 1;
+      stack[x] = i->result;
+      *tail = i;
+      tail = &i->next;
+  }
+
+  tail = &b->first;
+  for (n=b->start; n<b->end; n++) {
+      c = f->code[n];
+      switch (c->kind) {
+        case labelCK:
+        case nopCK:
+             break;
+        case iloadCK:
+        case aloadCK:
+             stack[sp++] = locals[codeinfoInt(c)];
+             break;
+        case istoreCK:
+        case astoreCK:
+             v = stack[--sp];
+             locals[codeinfoInt(c)] = v;
+             if (s->local[v]==-1) s->local[v] = codeinfoInt(c);
+             break;
+        case iincCK:
+             k = ssaInstr(ldc_intCK,makeCODEldc_int(c->val.iincC.amount,NULL),0,j);
+             k->result = ssaValue(s,SSAINT,k);
+             *tail = k;
+             tail = &k->next;
+             i = ssaInstr(iaddCK,makeCODEiadd(NULL),2,j);
+             i->args[0] = locals[c->val.iincC.offset];
+             i->args[1] = k->result;
+             i->result = ssaValue(s,SSAINT,i);
+             s->local[i->result] = c->val.iincC.offset;
+             locals[c->val.iincC.offset] = i->result;
+             *tail = i;
+             tail = &i->next;
+             break;
+        case dupCK:
+             stack[sp] = stack[sp-1];
+             sp++;
+             break;
+        case swapCK:
+             v = stack[sp-1];
+             stack[sp-1] = stack[sp-2];
+             stack[sp-2] = v;
+             break;
+        case popCK:
+             sp--;
+             break;
+        default:
+             pops = codeinfoPops(c);
+             sp -= pops;
+             carried = codeinfo[c->kind].flags&CIBRANCH ? sp : 0;
+             i = ssaInstr(c->kind,c,carried+pops,j);
+             i->carried = carried;
+             for (x=0; x<i->argc; x++) i->args[x] = stack[sp-carried+x];
+             if (ssaIsInit(c)) {
+                /* the copies of a new object left on the stack are a
+                 * different value once it is initialized
+                 */
+                recv = stack[sp];
+                if (s->def[recv]!=NULL && s->def[recv]->kind==newCK &&
+                    s->def[recv]->block==j) {
+                   i->result = ssaValue(s,SSAREF,i);
+                   for (x=0; x<sp; x++) {
+                       if (stack[x]==recv) stack[x] = i->result;
+                   }
+                   for (x=0; x<f->localslimit; x++) {
+                       if (locals[x]==recv) locals[x] = i->result;
+                   }
+                } else if (isstatic || s->formal[recv]!=0) {
+                   return -1;
+                }
+             } else if (codeinfoPushes(c)) {
+                i->result = ssaValue(s,ssaType(c),i);
+                stack[sp++] = i->result;
+             }
+             *tail = i;
+             tail = &i->next;
+             break;
+      }
+  }
+
+  c = f->code[b->end-1];
+  if (!(codeinfo[c->kind].flags&(CIBRANCH|CITERMINATOR)) && sp>0) {
+     i = ssaInstr(SSAEXIT,NULL,sp,j);
+     i->carried = sp;
+     for (x=0; x<sp; x++) i->args[x] = stack[x];
+     *tail = i;
+  }
+  return sp;
+}
+
+SSA *ssaBuild(CODE *c, FORMAL *formals, int isstatic, int localslimit)
+{ SSA *s;
+  FLOW *f;
+  SSABLOCK *b;
+  SSAINSTR *i;
+  int *blockof, *locals, *stack, **outlocals, **outstack, *outheight;
+  int j, k, x, v, change;
+
+  f = flowCODE(c,localslimit);
+  if (f->count==0) return NULL;
+  s = NEW(SSA);
+  s->flow = f;
+  s->valuec = 0;
+  s->valuemax = 64;
+  s->type = Malloc(s->valuemax*sizeof(int));
+  s->def = Malloc(s->valuemax*sizeof(SSAINSTR *));
+  s->formal = Malloc(s->valuemax*sizeof(int));
+  s->local = Malloc(s->valuemax*sizeof(int));
+  s->uses = NULL;
+  ssaValue(s,SSANONE,NULL);
+  blockof = Malloc((f->count+1)*sizeof(int));
+  if (!ssaBlocks(s,blockof)) return NULL;
+
+  locals = Malloc((localslimit+1)*sizeof(int));
+  stack = Malloc((f->stacklimit+1)*sizeof(int));
+  outlocals = Malloc(s->blockc*sizeof(int *));
+  outstack = Malloc(s->blockc*sizeof(int *));
+  outheight = Malloc(s->blockc*sizeof(int));
+
+  /* the entry block defines this and the formals */
+  for (x=0; x<localslimit; x++) locals[x] = SSAUNDEF;
+  if (!isstatic) {
+     v = ssaValue(s,SSAREF,NULL);
+     s->formal[v] = s->local[v] = 0;
+     locals[0] = v;
+  }
+  for (; formals!=NULL; formals=formals->next) {
+      v = ssaValue(s,formals->type->kind==refK ? SSAREF : SSAINT,NULL);
+      s->formal[v] = s->local[v] = formals->offset;
+      locals[formals->offset] = v;
+  }
+  outlocals[0] = ssaCopyInts(locals,localslimit);
+  outstack[0] = stack;
+  outheight[0] = 0;
+
+  for (j=1; j<s->blockc; j++) {
+      outheight[j] = ssaRename(s,j,locals,stack,isstatic);
+      if (outheight[j]<0) return NULL;
+      outlocals[j] = ssaCopyInts(locals,localslimit);
+      outstack[j] = ssaCopyInts(stack,outheight[j]);
+  }
+
+  for (j=1; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      for (k=0; k<b->predc; k++) {
+          if (outheight[b->preds[k]]!=f->height[b->start]) return NULL;
+      }
+      x = 0;
+      for (i=b->phis; i!=NULL; i=i->next) {
+          for (k=0; k<b->predc; k++) {
+              if (i->carried) {
+                 i->args[k] = outstack[b->preds[k]][x];
+              } else {
+                 i->args[k] = outlocals[b->preds[k]][s->local[i->result]];
+              }
+          }
+          if (i->carried) x++;
+      }
+  }
+
+  do {
+    change = 0;
+    for (j=1; j<s->blockc; j++) {
+        for (i=s->blocks[j].phis; i!=NULL; i=i->next) {
+            if (s->type[i->result]!=SSANONE) continue;
+            for (k=0; k<i->argc; k++) {
+                if (s->type[i->args[k]]!=SSANONE) {
+                   s->type[i->result] = s->type[i->args[k]];
+                   change = 1;
+                   break;
+                }
+            }
+        }
+    }
+  } while (change);
+  return s;
+}
+
+void ssaCount(SSA *s)
+{ SSABLOCK *b;
+  SSAINSTR *i;
+  int j, k;
+  s->uses = Malloc((s->valuec+1)*sizeof(int));
+  for (k=0; k<s->valuec; k++) s->uses[k] = 0;
+  for (j=0; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      for (i=b->phis; i!=NULL; i=i->next) {
+          for (k=0; k<i->argc; k++) s->uses[i->args[k]]++;
+      }
+      for (i=b->first; i!=NULL; i=i->next) {
+          for (k=0; k<i->argc; k++) s->uses[i->args[k]]++;
+      }
+  }
+}
+
+void ssaReplace(SSA *s, int from, int to)
+{ SSABLOCK *b;
+  SSAINSTR *i;
+  int j, k;
+  for (j=0; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      for (i=b->phis; i!=NULL; i=i->next) {
+          for (k=0; k<i->argc; k++) {
+              if (i->args[k]==from) i->args[k] = to;
+          }
+      }
+      for (i=b->first; i!=NULL; i=i->next) {
+          for (k=0; k<i->argc; k++) {
+              if (i->args[k]==from) i->args[k] = to;
+          }
+      }
+  }
+}
+
+/* 1 if i may be deleted when its value is unused */
+int ssaPure(SSA *s, SSAINSTR *i)
+{ SSAINSTR *d;
+  switch (i->kind) {
+    case SSAPHI:
+         return !i->carried;
+    case SSAEXIT:
+         return 0;
+    case instanceofCK:
+         return 1;
+    case idivCK:
+    case iremCK:
+         d = s->def[i->args[1]];
+         return d!=NULL && d->kind==ldc_intCK && d->code->val.ldc_intC!=0;
+    default:
+         return (codeinfo[i->kind].flags&CIPURE)!=0;
+  }
+}
+
+/* the branch or exit that ends b, if any */
+SSAINSTR *ssaTerminator(SSABLOCK *b)
+{ SSAINSTR *i;
+  if (b->first==NULL) return NULL;
+  for (i=b->first; i->next!=NULL; i=i->next);
+  if (i->kind==SSAEXIT ||
+      (i->kind>=0 && (codeinfo[i->kind].flags&(CIBRANCH|CITERMINATOR)))) {
+     return i;
+  }
+  return NULL;
+}
+
+void ssaRemoveEdge(SSA *s, int from, int to)
+{ SSABLOCK *b;
+  SSAINSTR *i;
+  int k, x;
+  b = &s->blocks[from];
+  for (k=0; k<b->succc && b->succs[k]!=to; k++);
+  if (k==b->succc) return;
+  for (; k+1<b->succc; k++) b->succs[k] = b->succs[k+1];
+  b->succc--;
+  if (b->fall==to) b->fall = -1;
+  if (b->target==to) b->target = -1;
+  b = &s->blocks[to];
+  for (k=0; k<b->predc && b->preds[k]!=from; k++);
+  if (k==b->predc) return;
+  for (x=k; x+1<b->predc; x++) b->preds[x] = b->preds[x+1];
+  b->predc--;
+  for (i=b->phis; i!=NULL; i=i->next) {
+      for (x=k; x+1<i->argc; x++) i->args[x] = i->args[x+1];
+      i->argc--;
+  }
+}
+
+int *ssaorder;
+
+void ssaPostorder(SSA *s, int j, char *seen, int *n)
+{ int k;
+  seen[j] = 1;
+  for (k=0; k<s->blocks[j].succc; k++) {
+      if (!seen[s->blocks[j].succs[k]]) ssaPostorder(s,s->blocks[j].succs[k],seen,n);
+  }
+  ssaorder[j] = (*n)++;
+}
+
+/* the immediate dominators, by the iteration of Cooper, Harvey and Kennedy */
+void ssaDominators(SSA *s)
+{ char *seen;
+  int *rpo, n, j, k, a, b, d, change;
+  seen = Malloc(s->blockc+1);
+  ssaorder = Malloc((s->blockc+1)*sizeof(int));
+  for (j=0; j<s->blockc; j++) {
+      seen[j] = 0;
+      s->blocks[j].idom = -1;
+  }
+  n = 0;
+  ssaPostorder(s,0,seen,&n);
+  rpo = Malloc((n+1)*sizeof(int));
+  for (j=0; j<s->blockc; j++) {
+      if (seen[j]) rpo[n-1-ssaorder[j]] = j;
+  }
+  s->blocks[0].idom = 0;
+  do {
+    change = 0;
+    for (k=1; k<n; k++) {
+        j = rpo[k];
+        d = -1;
+        for (a=0; a<s->blocks[j].predc; a++) {
+            b = s->blocks[j].preds[a];
+            if (s->blocks[b].idom==-1) continue;
+            if (d==-1) {
+               d = b;
+               continue;
+            }
+            while (b!=d) {
+              while (ssaorder[b]<ssaorder[d]) b = s->blocks[b].idom;
+              while (ssaorder[d]<ssaorder[b]) d = s->blocks[d].idom;
+            }
+        }
+        if (d!=s->blocks[j].idom) {
+           s->blocks[j].idom = d;
+           change = 1;
+        }
+    }
+  } while (change);
+}
+
+/* The state of ssaStackify.  Values that get a local are numbered by
+ * home; a class of homes shares one local.
+ */
+int *ssadirect;             /* uses by instructions other than phis */
+int *ssaphiuses;            /* uses by phis that are not carried */
+char *ssaallin;             /* 1 if every direct use is in its own block */
+char *ssaresident;          /* 1 if it stays on the stack */
+int *ssamult;               /* the copies of a resident value */
+int *ssainit;               /* what a new object is once initialized */
+int *ssahome;               /* its home, or -1 */
+int *ssalocal;              /* the local of a value with a home */
+int ssahomec;
+int *ssavalueof;            /* the value of a home */
+unsigned char *ssaconflict;
+unsigned char **ssalivein;  /* the homes live into a block */
+unsigned char **ssaphidef;  /* the homes its phis define */
+int *ssaparent, *ssamember, *ssalast, *ssapin, *ssaslotof;
+int ssafailed;
+CODE *ssacode, **ssatail;
+
+#define SSABIT(set,k) ((set)[(k)>>3]&(1<<((k)&7)))
+#define SSASET(set,k) ((set)[(k)>>3] |= (1<<((k)&7)))
+#define SSACLEAR(set,k) ((set)[(k)>>3] &= ~(1<<((k)&7)))
+
+int ssaConstant(SSA *s, int v)
+{ SSAINSTR *d;
+  d = s->def[v];
+  return d!=NULL && (d->kind==ldc_intCK || d->kind==ldc_stringCK ||
+                     d->kind==aconst_nullCK);
+}
+
+/* 1 for a new object that is not initialized yet */
+int ssaPinned(SSA *s, int v)
+{ return v>=0 && s->def[v]!=NULL && s->def[v]->kind==newCK;
+}
+
+int ssaUsed(int v)
+{ return ssadirect[v]+ssaphiuses[v]>0;
+}
+
+int ssaDefBlock(SSA *s, int v)
+{ if (s->def[v]!=NULL) return s->def[v]->block;
+  return v==SSAUNDEF ? -1 : 0;
+}
+
+/* the carried phis of b, bottom of the stack first */
+int ssaCarried(SSABLOCK *b, int *phis)
+{ SSAINSTR *i;
+  int h;
+  h = 0;
+  for (i=b->phis; i!=NULL; i=i->next) {
+      if (i->carried) phis[h++] = i->result;
+  }
+  return h;
+}
+
+/* the number of carried phis left on the stack on entry */
+int ssaCut(int *phis, int h)
+{ int x;
+  for (x=0; x<h; x++) {
+      if (!ssaresident[phis[x]]) return x;
+  }
+  return h;
+}
+
+void ssaUses(SSA *s)
+{ SSABLOCK *b;
+  SSAINSTR *i;
+  int j, k, v;
+  ssadirect = Malloc((s->valuec+1)*sizeof(int));
+  ssaphiuses = Malloc((s->valuec+1)*sizeof(int));
+  ssaallin = Malloc(s->valuec+1);
+  ssainit = Malloc((s->valuec+1)*sizeof(int));
+  for (v=0; v<s->valuec; v++) {
+      ssadirect[v] = ssaphiuses[v] = 0;
+      ssaallin[v] = 1;
+      ssainit[v] = -1;
+  }
+  for (j=0; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      for (i=b->phis; i!=NULL; i=i->next) {
+          if (i->carried) continue;
+          for (k=0; k<i->argc; k++) ssaphiuses[i->args[k]]++;
+      }
+      for (i=b->first; i!=NULL; i=i->next) {
+          for (k=0; k<i->argc; k++) {
+              ssadirect[i->args[k]]++;
+              if (ssaDefBlock(s,i->args[k])!=j) ssaallin[i->args[k]] = 0;
+          }
+          if (ssaIsInit(i->code) && i->result>=0 && ssaPinned(s,i->args[0])) {
+             ssainit[i->args[0]] = i->result;
+          }
+      }
+  }
+}
+
+/* 1 if i is the initialization of an object made by new in its block */
+int ssaNewInit(SSA *s, SSAINSTR *i)
+{ return i->argc>0 && ssaIsInit(i->code) && ssaPinned(s,i->args[0]);
+}
+
+/* The schedule of one block: its instructions, where its values are
+ * pushed, and the operands loaded early, below a value that an earlier
+ * instruction leaves on the stack for the same instruction.
+ */
+SSAINSTR **ssainstrs;
+int ssainstrc;
+int *ssapos;                /* where a value of the block is pushed, or -1 */
+int *ssadefat;              /* where it is defined, or -1 */
+int *ssastart;              /* where the pushes for an instruction start */
+int *ssaargbase;            /* the operands of an instruction in ssaleaf */
+int *ssaleaf;               /* the early load of an operand, or -1 */
+int *ssaleafat, *ssaleafq, *ssaleafk, *ssaleafv;
+int ssaleafc;
+
+#define SSALEAF(s,l) (-2-(s)->valuec-(l))
+
+void ssaSchedule(SSA *s, int j)
+{ SSAINSTR *i;
+  int q, k, r, v, st, x, t;
+  ssainstrc = 0;
+  for (i=s->blocks[j].first; i!=NULL; i=i->next) ssainstrs[ssainstrc++] = i;
+  for (v=0; v<s->valuec; v++) ssapos[v] = ssadefat[v] = -1;
+  ssaleafc = 0;
+  for (q=0; q<ssainstrc; q++) {
+      i = ssainstrs[q];
+      ssaargbase[q] = q==0 ? 0 : ssaargbase[q-1]+ssainstrs[q-1]->argc;
+      if (i->result>=0) ssadefat[i->result] = q;
+      if (i->kind==newCK && ssainit[i->result]!=-1) ssapos[ssainit[i->result]] = q;
+      if (i->result>=0 && !ssaNewInit(s,i)) ssapos[i->result] = q;
+      st = q;
+      for (k=0; k<i->argc; k++) {
+          v = i->args[k];
+          if (!ssaresident[v]) continue;
+          if (ssapos[v]==-1 || ssamult[v]!=1 || ssastart[ssapos[v]]==-1) {
+             st = -1;
+             break;
+          }
+          if (ssastart[ssapos[v]]<st) st = ssastart[ssapos[v]];
+      }
+      ssastart[q] = st;
+  }
+  for (q=0; q<ssainstrc; q++) {
+      i = ssainstrs[q];
+      for (k=0; k<i->argc; k++) {
+          ssaleaf[ssaargbase[q]+k] = -1;
+          v = i->args[k];
+          if (ssaresident[v]) continue;
+          for (r=k+1; r<i->argc && !ssaresident[i->args[r]]; r++);
+          if (r==i->argc) continue;
+          x = ssapos[i->args[r]];
+          if (x==-1 || ssamult[i->args[r]]!=1 || ssastart[x]==-1) continue;
+          st = ssastart[x];
+          /* a local must hold the value where it is loaded */
+          if (!ssaConstant(s,v) && ssadefat[v]>=st) continue;
+          ssaleaf[ssaargbase[q]+k] = ssaleafc;
+          ssaleafat[ssaleafc] = st;
+          ssaleafq[ssaleafc] = q;
+          ssaleafk[ssaleafc] = k;
+          ssaleafv[ssaleafc++] = v;
+      }
+  }
+
+  /* by position; at one position the operands of a later instruction
+   * go first, as it is further down the stack
+   */
+  for (x=1; x<ssaleafc; x++) {
+      for (k=x; k>0; k--) {
+          r = k-1;
+          if (ssaleafat[r]<ssaleafat[k] ||
+              (ssaleafat[r]==ssaleafat[k] && ssaleafq[r]>ssaleafq[k]) ||
+              (ssaleafat[r]==ssaleafat[k] && ssaleafq[r]==ssaleafq[k] &&
+               ssaleafk[r]<ssaleafk[k])) break;
+          t = ssaleafat[r]; ssaleafat[r] = ssaleafat[k]; ssaleafat[k] = t;
+          t = ssaleafq[r]; ssaleafq[r] = ssaleafq[k]; ssaleafq[k] = t;
+          t = ssaleafk[r]; ssaleafk[r] = ssaleafk[k]; ssaleafk[k] = t;
+          t = ssaleafv[r]; ssaleafv[r] = ssaleafv[k]; ssaleafv[k] = t;
+          ssaleaf[ssaargbase[ssaleafq[r]]+ssaleafk[r]] = r;
+          ssaleaf[ssaargbase[ssaleafq[k]]+ssaleafk[k]] = k;
+      }
+  }
+}
+
+/* the number of operands of the q'th instruction up to its last one
+ * kept on the stack
+ */
+int ssaStacked(int q)
+{ int n;
+  for (n=ssainstrs[q]->argc; n>0 && !ssaresident[ssainstrs[q]->args[n-1]]; n--);
+  return n;
+}
+
+/* 1 if the q'th instruction loads its first operand and swaps it under
+ * the second
+ */
+int ssaSwapped(int q)
+{ return ssainstrs[q]->argc==2 && ssaStacked(q)==2 &&
+         !ssaresident[ssainstrs[q]->args[0]] && ssaleaf[ssaargbase[q]]==-1;
+}
+
+/* The values that could go to a local when the stack does not fit, best
+ * first, and where the simulation stopped
+ */
+int *ssacand;
+int ssacandc, ssafailat;
+char *ssaswap;              /* 1 if a swap goes before an instruction */
+
+void ssaCandidate(SSA *s, int v)
+{ int k;
+  if (v<0 || !ssaresident[v] || ssaPinned(s,v)) return;
+  for (k=0; k<ssacandc; k++) {
+      if (ssacand[k]==v) return;
+  }
+  ssacand[ssacandc++] = v;
+}
+
+/* the operand the q'th instruction expects k'th on the stack */
+int ssaExpected(SSA *s, int q, int k)
+{ SSAINSTR *i;
+  i = ssainstrs[q];
+  return ssaresident[i->args[k]] ? i->args[k] : SSALEAF(s,ssaleaf[ssaargbase[q]+k]);
+}
+
+/* Checks that the operands of the q'th instruction that are not loaded by
+ * it are on top of the stack in order, swapping the top two if that is
+ * enough, and pops them.  Returns -1 if so, else the best of the
+ * candidates, or -2 if there are none.
+ */
+int ssaOperands(SSA *s, int q, int *stack, int *sp)
+{ SSAINSTR *i;
+  int n, k, r, e, x;
+  i = ssainstrs[q];
+  n = ssaStacked(q);
+  ssaswap[q] = 0;
+  ssacandc = 0;
+  ssafailat = q;
+  if (ssaSwapped(q)) {
+     if (*sp>0 && stack[*sp-1]==i->args[1]) {
+        (*sp)--;
+        return -1;
+     }
+     ssaCandidate(s,i->args[1]);
+     if (*sp>0) ssaCandidate(s,stack[*sp-1]);
+     return ssacandc>0 ? ssacand[0] : -2;
+  }
+  for (k=0; k<n; k++) {
+      if (!ssaresident[i->args[k]] && ssaleaf[ssaargbase[q]+k]==-1) {
+         for (r=k+1; !ssaresident[i->args[r]]; r++);
+         ssaCandidate(s,i->args[r]);
+         if (*sp>0) ssaCandidate(s,stack[*sp-1]);
+         return ssacandc>0 ? ssacand[0] : -2;
+      }
+  }
+  if (*sp>=2 && ((n==1 && stack[*sp-2]==ssaExpected(s,q,0) &&
+                  stack[*sp-1]!=stack[*sp-2]) ||
+                 (n==2 && stack[*sp-2]==ssaExpected(s,q,1) &&
+                  stack[*sp-1]==ssaExpected(s,q,0) &&
+                  stack[*sp-1]!=stack[*sp-2]))) {
+     ssaswap[q] = 1;
+     e = stack[*sp-1];
+     stack[*sp-1] = stack[*sp-2];
+     stack[*sp-2] = e;
+  }
+  for (k=0; k<n; k++) {
+      x = ssaExpected(s,q,k);
+      e = *sp-n+k>=0 ? stack[*sp-n+k] : -1;
+      if (e!=x) {
+         /* the copies of a new object stay where new pushed them */
+         if (e>=0 && !ssaNewInit(s,s->def[e])) ssaCandidate(s,e);
+         for (r=0; r<n; r++) ssaCandidate(s,i->args[r]);
+         for (r=*sp-n; r<*sp; r++) {
+             if (r>=0) ssaCandidate(s,stack[r]);
+         }
+         return ssacandc>0 ? ssacand[0] : -2;
+      }
+  }
+  *sp -= n;
+  return -1;
+}
+
+/* Simulates the stack of block j as ssaEmitBlock will leave it.  Returns
+ * -1 if every value marked resident can stay on the stack, else as
+ * ssaOperands.  A new object is pushed with its copies below it; when the
+ * initialized object goes to a local one copy is kept as a marker.
+ */
+int ssaCheckBlock(SSA *s, int j, int *stack, int *phis)
+{ SSAINSTR *i;
+  int sp, h, cut, x, r, v, q, l;
+  h = ssaCarried(&s->blocks[j],phis);
+  cut = ssaCut(phis,h);
+  ssafailat = -1;
+  ssacandc = 0;
+  for (x=cut+1; x<h; x++) {
+      if (ssaresident[phis[x]]) return ssacand[ssacandc++] = phis[x];
+  }
+  sp = 0;
+  for (x=0; x<cut; x++) {
+      /* only the top one can be duplicated */
+      if (x<cut-1 && ssamult[phis[x]]>1) return ssacand[ssacandc++] = phis[x];
+      for (r=0; r<ssamult[phis[x]]; r++) stack[sp++] = phis[x];
+  }
+  ssaSchedule(s,j);
+  l = 0;
+  for (q=0; q<ssainstrc; q++) {
+      i = ssainstrs[q];
+      while (l<ssaleafc && ssaleafat[l]==q) {
+        stack[sp++] = SSALEAF(s,l);
+        l++;
+      }
+      if (i->result>=0 && ssaConstant(s,i->result)) continue;
+      ssafailat = q;
+      ssacandc = 0;
+      if (i->kind==newCK) {
+         if (!ssaresident[i->result] || ssamult[i->result]!=1) return -2;
+         v = ssainit[i->result];
+         if (v!=-1 && ssaUsed(v)) {
+            if (ssaresident[v]) {
+               for (r=0; r<ssamult[v]; r++) stack[sp++] = v;
+            } else {
+               stack[sp++] = -2-v;
+            }
+         }
+         stack[sp++] = i->result;
+         continue;
+      }
+      r = ssaOperands(s,q,stack,&sp);
+      if (r!=-1) return r;
+      v = i->result;
+      if (v<0) continue;
+      if (ssaNewInit(s,i)) {
+         if (ssaUsed(v) && !ssaresident[v]) {
+            if (sp==0 || stack[sp-1]!=-2-v) return -2;
+            sp--;
+         }
+      } else if (ssaresident[v]) {
+         for (r=0; r<ssamult[v]; r++) stack[sp++] = v;
+      }
+  }
+  return sp==0 ? -1 : -2;
+}
+
+/* Decides which values stay on the stack; returns 0 if the code cannot be
+ * stackified.
+ */
+int ssaResidents(SSA *s, int *stack, int *phis)
+{ SSAINSTR *d;
+  int *cand, v, j, r, k, n, x, at;
+  ssaresident = Malloc(s->valuec+1);
+  ssamult = Malloc((s->valuec+1)*sizeof(int));
+  for (v=0; v<s->valuec; v++) {
+      d = s->def[v];
+      ssamult[v] = ssadirect[v];
+      ssaresident[v] = d!=NULL && !ssaConstant(s,v) &&
+                       (d->kind!=SSAPHI || d->carried) &&
+                       ssaphiuses[v]==0 && ssadirect[v]>0 && ssaallin[v];
+  }
+  cand = Malloc((s->valuec+1)*sizeof(int));
+  for (j=1; j<s->blockc; j++) {
+      if (!s->blocks[j].live) continue;
+      for (;;) {
+        r = ssaCheckBlock(s,j,stack,phis);
+        if (r==-1) break;
+        if (r==-2) return 0;
+        /* the first candidate that gets the simulation further */
+        at = ssafailat;
+        n = ssacandc;
+        memcpy(cand,ssacand,n*sizeof(int));
+        for (k=0; k<n; k++) {
+            ssaresident[cand[k]] = 0;
+            x = ssaCheckBlock(s,j,stack,phis);
+            ssaresident[cand[k]] = 1;
+            if (x==-1 || ssafailat>at) {
+               r = cand[k];
+               break;
+            }
+        }
+        ssaresident[r] = 0;
+      }
+  }
+  return 1;
+}
+
+/* Numbers the values that need a local; returns 0 if one has no type */
+int ssaHomes(SSA *s)
+{ int v;
+  ssahome = Malloc((s->valuec+1)*sizeof(int));
+  ssalocal = Malloc((s->valuec+1)*sizeof(int));
+  ssavalueof = Malloc((s->valuec+1)*sizeof(int));
+  ssahomec = 0;
+  for (v=0; v<s->valuec; v++) {
+      ssahome[v] = ssalocal[v] = -1;
+      if (v==SSAUNDEF || ssaresident[v] || ssaConstant(s,v)) continue;
+      if (!ssaUsed(v) && s->formal[v]==-1) continue;
+      /* nothing would store it; ssaLoad then gives up */
+      if (s->def[v]==NULL && s->formal[v]==-1) continue;
+      if (s->type[v]==SSANONE) return 0;
+      ssavalueof[ssahomec] = v;
+      ssahome[v] = ssahomec++;
+  }
+  return 1;
+}
+
+int ssaHomed(int v)
+{ return v>=0 && ssahome[v]!=-1;
+}
+
+/* the homes defined at the start of block j */
+void ssaPhiDefs(SSA *s, int j, unsigned char *set)
+{ SSAINSTR *i;
+  int v;
+  if (j==0) {
+     for (v=0; v<s->valuec; v++) {
+         if (s->formal[v]!=-1 && ssaHomed(v)) SSASET(set,ssahome[v]);
+     }
+     return;
+  }
+  for (i=s->blocks[j].phis; i!=NULL; i=i->next) {
+      if (ssaHomed(i->result)) SSASET(set,ssahome[i->result]);
+  }
+}
+
+int ssaPredIndex(SSA *s, int t, int j)
+{ int k;
+  for (k=0; k<s->blocks[t].predc && s->blocks[t].preds[k]!=j; k++);
+  return k;
+}
+
+void ssaConflict(int a, int b)
+{ if (a==b) return;
+  SSASET(ssaconflict,a*ssahomec+b);
+  SSASET(ssaconflict,b*ssahomec+a);
+}
+
+/* Computes which homes are live at the same time */
+void ssaInterference(SSA *s)
+{ SSABLOCK *b;
+  SSAINSTR *i, **instrs;
+  unsigned char **use, **def, **phidef, **in, *out, *live;
+  int bytes, j, k, x, n, t, change;
+  bytes = ssahomec/8+1;
+  use = Malloc(s->blockc*sizeof(unsigned char *));
+  def = Malloc(s->blockc*sizeof(unsigned char *));
+  phidef = ssaphidef = Malloc(s->blockc*sizeof(unsigned char *));
+  in = ssalivein = Malloc(s->blockc*sizeof(unsigned char *));
+  out = Malloc(bytes);
+  live = Malloc(bytes);
+  n = 1;
+  for (j=0; j<s->blockc; j++) {
+      use[j] = Malloc(bytes);
+      def[j] = Malloc(bytes);
+      phidef[j] = Malloc(bytes);
+      in[j] = Malloc(bytes);
+      memset(use[j],0,bytes);
+      memset(def[j],0,bytes);
+      memset(phidef[j],0,bytes);
+      memset(in[j],0,bytes);
+      if (!s->blocks[j].live) continue;
+      ssaPhiDefs(s,j,phidef[j]);
+      for (i=s->blocks[j].first; i!=NULL; i=i->next) {
+          n++;
+          for (k=0; k<i->argc; k++) {
+              x = i->args[k];
+              if (ssaHomed(x) && !SSABIT(def[j],ssahome[x])) SSASET(use[j],ssahome[x]);
+          }
+          if (ssaHomed(i->result)) SSASET(def[j],ssahome[i->result]);
+      }
+  }
+  instrs = Malloc(n*sizeof(SSAINSTR *));
+
+  /* out(j) is what its successors need past their phis, and the args of
+   * their phis from j
+   */
+  do {
+    change = 0;
+    for (j=s->blockc-1; j>=0; j--) {
+        b = &s->blocks[j];
+        if (!b->live) continue;
+        memset(out,0,bytes);
+        for (k=0; k<b->succc; k++) {
+            t = b->succs[k];
+            for (x=0; x<bytes; x++) out[x] |= in[t][x]&~phidef[t][x];
+            n = ssaPredIndex(s,t,j);
+            for (i=s->blocks[t].phis; i!=NULL; i=i->next) {
+                if (!i->carried && ssaHomed(i->result) && ssaHomed(i->args[n])) {
+                   SSASET(out,ssahome[i->args[n]]);
+                }
+            }
+        }
+        for (x=0; x<bytes; x++) {
+            live[x] = use[j][x]|(out[x]&~def[j][x]);
+            if (live[x]!=in[j][x]) {
+               in[j][x] = live[x];
+               change = 1;
+            }
+        }
+    }
+  } while (change);
+
+  ssaconflict = Malloc(ssahomec*ssahomec/8+1);
+  memset(ssaconflict,0,ssahomec*ssahomec/8+1);
+  for (j=0; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      if (!b->live) continue;
+      memset(live,0,bytes);
+      for (k=0; k<b->succc; k++) {
+          t = b->succs[k];
+          for (x=0; x<bytes; x++) live[x] |= in[t][x]&~phidef[t][x];
+          n = ssaPredIndex(s,t,j);
+          for (i=s->blocks[t].phis; i!=NULL; i=i->next) {
+              if (!i->carried && ssaHomed(i->result) && ssaHomed(i->args[n])) {
+                 SSASET(live,ssahome[i->args[n]]);
+              }
+          }
+      }
+      n = 0;
+      for (i=b->first; i!=NULL; i=i->next) instrs[n++] = i;
+      while (n>0) {
+        i = instrs[--n];
+        if (ssaHomed(i->result)) {
+           for (x=0; x<ssahomec; x++) {
+               if (SSABIT(live,x)) ssaConflict(ssahome[i->result],x);
+           }
+           SSACLEAR(live,ssahome[i->result]);
+        }
+        for (k=0; k<i->argc; k++) {
+            if (ssaHomed(i->args[k])) SSASET(live,ssahome[i->args[k]]);
+        }
+      }
+      for (x=0; x<ssahomec; x++) {
+          if (!SSABIT(phidef[j],x)) continue;
+          for (k=0; k<ssahomec; k++) {
+              if (SSABIT(live,k) || SSABIT(phidef[j],k)) ssaConflict(x,k);
+          }
+      }
+  }
+}
+
+int ssaFind(int h)
+{ while (ssaparent[h]!=h) h = ssaparent[h];
+  return h;
+}
+
+/* 1 if some home of class a is live with some home of class b */
+int ssaClassConflict(int a, int b)
+{ int x, y;
+  for (x=a; x!=-1; x=ssamember[x]) {
+      for (y=b; y!=-1; y=ssamember[y]) {
+          if (SSABIT(ssaconflict,x*ssahomec+y)) return 1;
+      }
+  }
+  return 0;
+}
+
+/* lets the values a and b share a local if their lives allow it */
+void ssaUnion(int a, int b)
+{ int ra, rb;
+  if (!ssaHomed(a) || !ssaHomed(b)) return;
+  ra = ssaFind(ssahome[a]);
+  rb = ssaFind(ssahome[b]);
+  if (ra==rb) return;
+  if (ssapin[ra]!=-1 && ssapin[rb]!=-1) return;
+  if (ssaClassConflict(ra,rb)) return;
+  ssaparent[rb] = ra;
+  ssamember[ssalast[ra]] = rb;
+  ssalast[ra] = ssalast[rb];
+  if (ssapin[ra]==-1) ssapin[ra] = ssapin[rb];
+}
+
+/* 1 if the class r may take local t */
+int ssaSlotFree(int r, int t)
+{ int h;
+  for (h=0; h<ssahomec; h++) {
+      if (ssaparent[h]==h && ssaslotof[h]==t && ssaClassConflict(r,h)) return 0;
+  }
+  return 1;
+}
+
+/* Gives every home a local and returns the number of locals used */
+int ssaLocals(SSA *s)
+{ SSAINSTR *i;
+  int h, j, k, r, t, x, v, limit, pass;
+  ssaparent = Malloc((ssahomec+1)*sizeof(int));
+  ssamember = Malloc((ssahomec+1)*sizeof(int));
+  ssalast = Malloc((ssahomec+1)*sizeof(int));
+  ssapin = Malloc((ssahomec+1)*sizeof(int));
+  ssaslotof = Malloc((ssahomec+1)*sizeof(int));
+  limit = 0;
+  for (h=0; h<ssahomec; h++) {
+      ssaparent[h] = ssalast[h] = h;
+      ssamember[h] = -1;
+      ssaslotof[h] = -1;
+      ssapin[h] = s->formal[ssavalueof[h]];
+      if (ssapin[h]>=limit) limit = ssapin[h]+1;
+  }
+
+  /* a phi and its args, and a value and the same value plus a constant,
+   * which an iinc can then update in place
+   */
+  for (j=1; j<s->blockc; j++) {
+      if (!s->blocks[j].live) continue;
+      for (i=s->blocks[j].phis; i!=NULL; i=i->next) {
+          if (i->carried || !ssaHomed(i->result)) continue;
+          for (k=0; k<i->argc; k++) ssaUnion(i->result,i->args[k]);
+      }
+      for (i=s->blocks[j].first; i!=NULL; i=i->next) {
+          if ((i->kind==iaddCK || i->kind==isubCK) && ssaConstant(s,i->args[1])) {
+             ssaUnion(i->result,i->args[0]);
+          }
+      }
+  }
+
+  for (pass=0; pass<2; pass++) {
+      for (h=0; h<ssahomec; h++) {
+          r = ssaFind(h);
+          if (ssaslotof[r]!=-1 || (ssapin[r]!=-1)!=(pass==0)) continue;
+          if (pass==0) {
+             ssaslotof[r] = ssapin[r];
+             continue;
+          }
+          for (x=r; x!=-1; x=ssamember[x]) {
+              t = s->local[ssavalueof[x]];
+              if (t>=0 && ssaSlotFree(r,t)) {
+                 ssaslotof[r] = t;
+                 break;
+              }
+          }
+          for (t=0; ssaslotof[r]==-1; t++) {
+              if (ssaSlotFree(r,t)) ssaslotof[r] = t;
+          }
+      }
+  }
+  for (h=0; h<ssahomec; h++) {
+      v = ssavalueof[h];
+      ssalocal[v] = ssaslotof[ssaFind(h)];
+      if (ssalocal[v]>=limit) limit = ssalocal[v]+1;
+  }
+  return limit;
+}
+
+/* the critical edges given a block of copies at the end of the code */
+CODE **ssasplitlabel, **ssasplitbranch;
+int ssasplitc;
+
+void ssaEmit(CODE *c)
+{ c->next = NULL;
+  *ssatail = c;
+  ssatail = &c->next;
+}
+
+CODE *ssaClone(CODE *c)
+{ CODE *d;
+  d = NEW(CODE);
+  *d = *c;
+  d->visited = 0;
+  d->next = NULL;
+  return d;
+}
+
+void ssaLoad(SSA *s, int v)
+{ if (ssaConstant(s,v)) {
+     ssaEmit(ssaClone(s->def[v]->code));
+  } else if (!ssaHomed(v)) {
+     ssafailed = 1;
+  } else if (s->type[v]==SSAREF) {
+     ssaEmit(makeCODEaload(ssalocal[v],NULL));
+  } else {
+     ssaEmit(makeCODEiload(ssalocal[v],NULL));
+  }
+}
+
+void ssaStore(SSA *s, int v)
+{ if (s->type[v]==SSAREF) {
+     ssaEmit(makeCODEastore(ssalocal[v],NULL));
+  } else {
+     ssaEmit(makeCODEistore(ssalocal[v],NULL));
+  }
+}
+
+/* Counts the copies into the phis of block t on the edge from j, and
+ * emits them if emit is set.  They go through the stack when one
+ * overwrites the source of another.
+ */
+int ssaEdgeCopies(SSA *s, int j, int t, int emit)
+{ SSAINSTR *i;
+  int *dst, *src, n, k, x, y, stacked;
+  k = ssaPredIndex(s,t,j);
+  n = 0;
+  for (i=s->blocks[t].phis; i!=NULL; i=i->next) n++;
+  dst = Malloc((n+1)*sizeof(int));
+  src = Malloc((n+1)*sizeof(int));
+  n = 0;
+  for (i=s->blocks[t].phis; i!=NULL; i=i->next) {
+      if (i->carried || !ssaHomed(i->result)) continue;
+      x = i->args[k];
+      if (x==SSAUNDEF || (!ssaHomed(x) && !ssaConstant(s,x))) {
+         ssafailed = 1;
+         continue;
+      }
+      if (ssaHomed(x) && ssalocal[x]==ssalocal[i->result]) continue;
+      dst[n] = i->result;
+      src[n++] = x;
+  }
+  if (!emit) return n;
+  stacked = 0;
+  for (x=0; x<n; x++) {
+      for (y=0; y<n; y++) {
+          if (x!=y && ssaHomed(src[y]) && ssalocal[src[y]]==ssalocal[dst[x]]) stacked = 1;
+      }
+  }
+  if (stacked) {
+     for (x=0; x<n; x++) ssaLoad(s,src[x]);
+     for (x=n-1; x>=0; x--) ssaStore(s,dst[x]);
+  } else {
+     for (x=0; x<n; x++) {
+         ssaLoad(s,src[x]);
+         ssaStore(s,dst[x]);
+     }
+  }
+  return n;
+}
+
+/* 1 if the copies for the taken edge of the branch ending block j can be
+ * made before the branch: the fall edge needs none of the locals they write
+ */
+int ssaHoistable(SSA *s, int j)
+{ SSABLOCK *b;
+  SSAINSTR *i, *p;
+  int t, f, n, h, d;
+  b = &s->blocks[j];
+  t = b->target;
+  f = b->fall;
+  if (f==t || f==-1) return 1;
+  n = ssaPredIndex(s,f,j);
+  for (i=s->blocks[t].phis; i!=NULL; i=i->next) {
+      if (i->carried || !ssaHomed(i->result)) continue;
+      d = ssalocal[i->result];
+      for (h=0; h<ssahomec; h++) {
+          if (SSABIT(ssalivein[f],h) && !SSABIT(ssaphidef[f],h) &&
+              ssalocal[ssavalueof[h]]==d) return 0;
+      }
+      for (p=s->blocks[f].phis; p!=NULL; p=p->next) {
+          if (p->carried || !ssaHomed(p->result)) continue;
+          if (ssalocal[p->result]==d) return 0;
+          if (ssaHomed(p->args[n]) && ssalocal[p->args[n]]==d) return 0;
+      }
+  }
+  return 1;
+}
+
+/* "store k; load k" becomes "dup; store k" where that is shorter */
+void ssaDupStores(CODE *c)
+{ CODE *n;
+  for (; c!=NULL && c->next!=NULL; c=c->next) {
+      n = c->next;
+      if (((c->kind==istoreCK && n->kind==iloadCK) ||
+           (c->kind==astoreCK && n->kind==aloadCK)) &&
+          codeinfoInt(c)==codeinfoInt(n) && codeinfoInt(c)>=4) {
+         n->kind = c->kind;
+         n->val = c->val;
+         c->kind = dupCK;
+      }
+  }
+}
+
+/* 1 if i adds a short constant to a value in the local it defines */
+int ssaIinc(SSA *s, SSAINSTR *i, int *amount)
+{ int x, y;
+  if ((i->kind!=iaddCK && i->kind!=isubCK) || !ssaHomed(i->result)) return 0;
+  x = i->args[0];
+  y = i->args[1];
+  if (!ssaHomed(x) || ssalocal[x]!=ssalocal[i->result]) return 0;
+  if (s->def[y]==NULL || s->def[y]->kind!=ldc_intCK) return 0;
+  *amount = s->def[y]->code->val.ldc_intC;
+  if (i->kind==isubCK) *amount = -*amount;
+  return *amount>=-32768 && *amount<=32767;
+}
+
+void ssaEmitBlock(SSA *s, int j, int *stack, int *phis)
+{ SSABLOCK *b;
+  SSAINSTR *i;
+  CODE *c;
+  int n, h, cut, x, r, v, q, l, amount;
+  b = &s->blocks[j];
+  for (n=b->start; n<b->end && s->flow->code[n]->kind==labelCK; n++) {
+      ssaEmit(ssaClone(s->flow->code[n]));
+  }
+  h = ssaCarried(b,phis);
+  cut = ssaCut(phis,h);
+  for (x=h-1; x>=cut; x--) {
+      if (ssaHomed(phis[x])) ssaStore(s,phis[x]);
+      else ssaEmit(makeCODEpop(NULL));
+  }
+  if (cut>0) {
+     for (r=1; r<ssamult[phis[cut-1]]; r++) ssaEmit(makeCODEdup(NULL));
+  }
+
+  if (j>0) ssaCheckBlock(s,j,stack,phis);
+  ssaSchedule(s,j);
+  l = 0;
+  for (q=0; q<ssainstrc; q++) {
+      i = ssainstrs[q];
+      while (l<ssaleafc && ssaleafat[l]==q) ssaLoad(s,ssaleafv[l++]);
+      if (i->result>=0 && ssaConstant(s,i->result)) continue;
+      if (i->kind==newCK) {
+         ssaEmit(ssaClone(i->code));
+         v = ssainit[i->result];
+         if (v!=-1 && ssaUsed(v)) {
+            for (r=0; r<(ssaresident[v] ? ssamult[v] : 1); r++) ssaEmit(makeCODEdup(NULL));
+         }
+         continue;
+      }
+      if (ssaIinc(s,i,&amount)) {
+         ssaEmit(makeCODEiinc(ssalocal[i->result],amount,NULL));
+         continue;
+      }
+      if (ssaswap[q]) ssaEmit(makeCODEswap(NULL));
+      if (ssaSwapped(q)) {
+         ssaLoad(s,i->args[0]);
+         ssaEmit(makeCODEswap(NULL));
+      } else {
+         for (x=ssaStacked(q); x<i->argc; x++) ssaLoad(s,i->args[x]);
+      }
+      if (i->kind==SSAEXIT) break;
+      if (i->kind>=0 && (codeinfo[i->kind].flags&CIBRANCH)) {
+         if (i->kind==gotoCK) {
+            ssaEdgeCopies(s,j,b->target,1);
+            ssaEmit(ssaClone(i->code));
+            return;
+         }
+         c = ssaClone(i->code);
+         if (ssaEdgeCopies(s,j,b->target,0)>0) {
+            if (ssaHoistable(s,j)) {
+               ssaEdgeCopies(s,j,b->target,1);
+               if (b->fall==b->target) {
+                  ssaEmit(c);
+                  return;
+               }
+            } else {
+               ssasplitbranch[ssasplitc] = c;
+               ssasplitlabel[ssasplitc++] = NULL;
+            }
+         }
+         ssaEmit(c);
+         break;
+      }
+      ssaEmit(ssaClone(i->code));
+      v = i->result;
+      if (v<0) continue;
+      if (ssaNewInit(s,i)) {
+         if (ssaUsed(v) && !ssaresident[v]) ssaStore(s,v);
+      } else if (!ssaUsed(v)) {
+         ssaEmit(makeCODEpop(NULL));
+      } else if (ssaresident[v]) {
+         for (r=1; r<ssamult[v]; r++) ssaEmit(makeCODEdup(NULL));
+      } else {
+         ssaStore(s,v);
+      }
+  }
+  if (b->fall!=-1) ssaEdgeCopies(s,j,b->fall,1);
+}
+
+/* the copies on the taken edge of the k'th split branch, from block j */
+void ssaEmitSplit(SSA *s, int k, int j)
+{ CODE *label;
+  label = makeCODElabel(0,NULL);
+  ssasplitlabel[k] = label;
+  ssaEmit(label);
+  ssaEdgeCopies(s,j,s->blocks[j].target,1);
+  ssaEmit(makeCODEgoto(codeinfoInt(ssasplitbranch[k]),NULL));
+}
+
+CODE *ssaStackify(SSA *s, int *localslimit)
+{ SSAINSTR *t;
+  int *stack, *phis, *splitblock, j, n, k, size;
+  ssaUses(s);
+  n = k = size = 1;
+  for (j=0; j<s->blockc; j++) {
+      for (t=s->blocks[j].phis; t!=NULL; t=t->next) {
+          size += t->argc+1+ssadirect[t->result];
+      }
+      for (t=s->blocks[j].first; t!=NULL; t=t->next) {
+          n++;
+          k += t->argc;
+          size += t->argc+1;
+          if (t->result>=0) size += ssadirect[t->result];
+      }
+  }
+  stack = Malloc(size*sizeof(int));
+  phis = Malloc(size*sizeof(int));
+  ssacand = Malloc((s->valuec+1)*sizeof(int));
+  ssaswap = Malloc(n);
+  ssainstrs = Malloc(n*sizeof(SSAINSTR *));
+  ssastart = Malloc(n*sizeof(int));
+  ssaargbase = Malloc(n*sizeof(int));
+  ssapos = Malloc((s->valuec+1)*sizeof(int));
+  ssadefat = Malloc((s->valuec+1)*sizeof(int));
+  ssaleaf = Malloc(k*sizeof(int));
+  ssaleafat = Malloc(k*sizeof(int));
+  ssaleafq = Malloc(k*sizeof(int));
+  ssaleafk = Malloc(k*sizeof(int));
+  ssaleafv = Malloc(k*sizeof(int));
+  if (!ssaResidents(s,stack,phis)) return NULL;
+  if (!ssaHomes(s)) return NULL;
+  ssaInterference(s);
+  *localslimit = ssaLocals(s);
+
+  ssasplitlabel = Malloc((s->blockc+1)*sizeof(CODE *));
+  ssasplitbranch = Malloc((s->blockc+1)*sizeof(CODE *));
+  splitblock = Malloc((s->blockc+1)*sizeof(int));
+  ssasplitc = 0;
+  ssafailed = 0;
+  ssacode = NULL;
+  ssatail = &ssacode;
+  for (j=0; j<s->blockc; j++) {
+      if (!s->blocks[j].live) continue;
+      k = ssasplitc;
+      ssaEmitBlock(s,j,stack,phis);
+      if (ssasplitc>k) splitblock[k] = j;
+  }
+  n = ssasplitc;
+  for (k=0; k<n; k++) ssaEmitSplit(s,k,splitblock[k]);
+  if (ssafailed) return NULL;
+  ssaDupStores(ssacode);
+  return ssacode;
+}
+
+/* Rewrites the code through the SSA form and keeps the result if it is
+ * smaller.  Returns 1 if it was kept.  The locals keep room for the
+ * arguments, as main has no FORMAL for its String[].
+ */
+int ssaCODE(CODE **c, FORMAL *formals, char *signature, int *localslimit,
+            int isstatic)
+{ SSA *s;
+  CODE *r, *p;
+  int limit, args, before, after, k, l;
+  s = ssaBuild(*c,formals,isstatic,*localslimit);
+  if (s==NULL) return 0;
+  ssaSave();
+  ssaOptimize(s);
+  r = ssaStackify(s,&limit);
+  args = entrySize(signature);
+  if (limit<args) limit = args;
+  before = after = 0;
+  if (r!=NULL) {
+     for (p=*c; p!=NULL; p=p->next) before += codeinfoSize(p);
+     for (p=r; p!=NULL; p=p->next) after += codeinfoSize(p);
+  }
+  if (r==NULL || after>=before) {
+     ssaRestore();
+     return 0;
+  }
+  for (k=0; k<ssasplitc; k++) {
+      l = next_label();
+      INSERTnewlabel(l,"split",ssasplitlabel[k],0);
+      ssasplitlabel[k]->val.labelC = l;
+      codeinfoSetInt(ssasplitbranch[k],l);
+  }
+  for (p=*c; p!=NULL; p=p->next) {
+      if (uses_label(p,&l)) droplabel(l);
+  }
+  for (p=r; p!=NULL; p=p->next) {
+      if (uses_label(p,&l)) copylabel(l);
+      if (p->kind==labelCK) movelabel(p->val.labelC,p);
+  }
+  *c = r;
+  *localslimit = limit;
+  ssamethods++;
+  return 1;
+}
@@ -0,0 +1,93 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* An SSA form of one method, the middle end behind -fssa.  Simulating the
+ * stack turns every instruction into one that reads and defines numbered
+ * values: loads, stores, dup, swap and pop disappear into the renaming, and
+ * every local and stack slot gets a phi at the start of every block.  A
+ * phi of a stack slot is carried: the value stays on the stack, so it is
+ * never removed, and the block that leaves it there lists it among the
+ * operands of its last instruction.
+ *
+ * ssaStackify turns the form back into stack code with the blocks, labels
+ * and order of the original.  A value used only by later instructions of
+ * its own block, in the order the stack delivers it, stays on the stack
+ * (with a dup for each extra use); constants are pushed again where used;
+ * every other value gets a local, shared with the phis it flows into when
+ * their lives do not overlap.
+ */
+
+#define SSAUNDEF 0              /* the value of a local never assigned */
+
+/* types of values */
+#define SSANONE 0
+#define SSAINT 1
+#define SSAREF 2
+
+/* kinds of SSAINSTR besides the CODE kinds */
+#define SSAPHI -1
+#define SSAEXIT -2              /* hands the carried values to the next block */
+
+typedef struct SSAINSTR {
+  int kind;
+  CODE *code;                   /* its operand, if kind is a CODE kind */
+  int result;                   /* the value defined, or -1 */
+  int argc;
+  int *args;                    /* bottom of the stack first; one per
+                                   predecessor for a phi */
+  int carried;                  /* phi: 1 if it stays on the stack;
+                                   otherwise how many args are carried */
+  int block;
+  struct SSAINSTR *next;
+} SSAINSTR;
+
+typedef struct SSABLOCK {
+  int start, end;               /* code[start..end) of the FLOW */
+  SSAINSTR *phis;
+  SSAINSTR *first;              /* ends with the branch or exit, if any */
+  int predc;
+  int *preds;
+  int succc;
+  int *succs;
+  int fall;                     /* the block it falls through to, or -1 */
+  int target;                   /* the block its branch jumps to, or -1 */
+  int idom;
+  int live;                     /* 0 once it is found unreachable */
+} SSABLOCK;
+
+typedef struct SSA {
+  struct FLOW *flow;
+  int blockc;                   /* block 0 is empty and defines the formals */
+  SSABLOCK *blocks;
+  int valuec, valuemax;
+  int *type;
+  SSAINSTR **def;               /* NULL for SSAUNDEF and the formals */
+  int *formal;                  /* the local of a formal, or -1 */
+  int *uses;                    /* filled by ssaCount */
+  int *local;                   /* the local a value was stored in, or -1 */
+} SSA;
+
+extern int ssamethods;
+
+SSAINSTR *ssaInstr(int kind, CODE *code, int argc, int block);
+SSA *ssaBuild(CODE *c, FORMAL *formals, int isstatic, int localslimit);
+void ssaCount(SSA *s);
+void ssaReplace(SSA *s, int from, int to);
+int ssaPure(SSA *s, SSAINSTR *i);
+SSAINSTR *ssaTerminator(SSABLOCK *b);
+void ssaRemoveEdge(SSA *s, int from, int to);
+void ssaDominators(SSA *s);
+CODE *ssaStackify(SSA *s, int *localslimit);
+int ssaCODE(CODE **c, FORMAL *formals, char *signature, int *localslimit,
+            int isstatic);
@@ -0,0 +1,587 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "codeinfo.h"
+#include "ssa.h"
+#include "ssaopt.h"
+
+int ssafolded, ssanumbered, ssaremoved;
+int ssasaved[3];
+
+void ssaSave()
+{ ssasaved[0] = ssafolded;
+  ssasaved[1] = ssanumbered;
+  ssasaved[2] = ssaremoved;
+}
+
+void ssaRestore()
+{ ssafolded = ssasaved[0];
+  ssanumbered = ssasaved[1];
+  ssaremoved = ssasaved[2];
+}
+
+int ssaBlockOf(SSA *s, int v)
+{ return s->def[v]!=NULL ? s->def[v]->block : 0;
+}
+
+/* 1 if block a dominates block b */
+int ssaDominates(SSA *s, int a, int b)
+{ for (;;) {
+    if (a==b) return 1;
+    if (b<=0 || s->blocks[b].idom<0) return 0;
+    b = s->blocks[b].idom;
+  }
+}
+
+/* Removes the phis whose args are all one value besides the phi itself
+ * and values never assigned, if that value dominates the phi.
+ */
+int ssaCopies(SSA *s)
+{ SSAINSTR *i, **p;
+  int j, k, v, removed, change;
+  removed = 0;
+  do {
+    change = 0;
+    ssaDominators(s);
+    for (j=1; j<s->blockc; j++) {
+        if (!s->blocks[j].live) continue;
+        p = &s->blocks[j].phis;
+        while (*p!=NULL) {
+          i = *p;
+          v = -1;
+          for (k=0; k<i->argc && !i->carried; k++) {
+              if (i->args[k]==i->result || i->args[k]==SSAUNDEF) continue;
+              if (v==-1) {
+                 v = i->args[k];
+              } else if (v!=i->args[k]) {
+                 v = -2;
+                 break;
+              }
+          }
+          if (v==-1) v = SSAUNDEF;
+          if (i->carried || v==-2 || !ssaDominates(s,ssaBlockOf(s,v),j)) {
+             p = &i->next;
+             continue;
+          }
+          *p = i->next;
+          ssaReplace(s,i->result,v);
+          s->def[i->result] = NULL;
+          removed++;
+          change = 1;
+        }
+    }
+  } while (change);
+  return removed;
+}
+
+/* the lattice of ssaConstants; a reference is 0 if null and 1 if not */
+#define SSATOP 0
+#define SSACONST 1
+#define SSABOTTOM 2
+
+int *ssastate, *ssaconst;
+char *ssaexec, *ssaexecfall, *ssaexectarget;
+int ssachange;
+
+void ssaLower(int v, int state, int c)
+{ if (ssastate[v]==SSABOTTOM || state==SSATOP) return;
+  if (state==SSACONST && ssastate[v]==SSACONST) {
+     if (ssaconst[v]==c) return;
+     state = SSABOTTOM;
+  }
+  ssastate[v] = state;
+  ssaconst[v] = c;
+  ssachange = 1;
+}
+
+/* folds an integer operation; returns 0 if it throws */
+int ssaFold(int kind, int a, int b, int *r)
+{ unsigned int x, y, q;
+  x = a;
+  y = b;
+  switch (kind) {
+    case iaddCK: *r = (int)(x+y); return 1;
+    case isubCK: *r = (int)(x-y); return 1;
+    case imulCK: *r = (int)(x*y); return 1;
+    case inegCK: *r = (int)(0u-x); return 1;
+    case i2cCK: *r = a&0xffff; return 1;
+    case idivCK:
+    case iremCK:
+         if (b==0) return 0;
+         if (a<0) x = 0u-x;
+         if (b<0) y = 0u-y;
+         if (kind==idivCK) {
+            q = x/y;
+            *r = (int)((a<0)!=(b<0) ? 0u-q : q);
+         } else {
+            q = x%y;
+            *r = (int)(a<0 ? 0u-q : q);
+         }
+         return 1;
+  }
+  return 0;
+}
+
+/* 1 if the conditional branch i jumps, 0 if it falls through, -1 if it
+ * may do either and -2 if its operands are not known yet
+ */
+int ssaDecide(SSAINSTR *i)
+{ int x, y, a, b;
+  x = i->args[i->carried];
+  y = i->argc>i->carried+1 ? i->args[i->carried+1] : x;
+  if (ssastate[x]==SSATOP || ssastate[y]==SSATOP) return -2;
+  if (ssastate[x]==SSABOTTOM || ssastate[y]==SSABOTTOM) return -1;
+  a = ssaconst[x];
+  b = ssaconst[y];
+  switch (i->kind) {
+    case ifeqCK: case ifnullCK: return a==0;
+    case ifneCK: case ifnonnullCK: return a!=0;
+    case ifltCK: return a<0;
+    case ifgeCK: return a>=0;
+    case ifgtCK: return a>0;
+    case ifleCK: return a<=0;
+    case if_icmpeqCK: return a==b;
+    case if_icmpneCK: return a!=b;
+    case if_icmpltCK: return a<b;
+    case if_icmpgeCK: return a>=b;
+    case if_icmpgtCK: return a>b;
+    case if_icmpleCK: return a<=b;
+    case if_acmpeqCK:
+         /* null is never equal to a reference known not to be null */
+         if (a==0 && b==0) return 1;
+         return a!=b ? 0 : -1;
+    case if_acmpneCK:
+         if (a==0 && b==0) return 0;
+         return a!=b ? 1 : -1;
+  }
+  return -1;
+}
+
+int ssaEdgeExecutable(SSA *s, int j, int t)
+{ return (s->blocks[j].fall==t && ssaexecfall[j]) ||
+         (s->blocks[j].target==t && ssaexectarget[j]);
+}
+
+void ssaReach(char *flag, int t)
+{ if (!*flag) {
+     *flag = 1;
+     ssachange = 1;
+  }
+  if (!ssaexec[t]) {
+     ssaexec[t] = 1;
+     ssachange = 1;
+  }
+}
+
+void ssaEvaluate(SSA *s, SSAINSTR *i)
+{ int k, a, b, r, v;
+  v = i->result;
+  if (v<0) return;
+  switch (i->kind) {
+    case ldc_intCK:
+         ssaLower(v,SSACONST,i->code->val.ldc_intC);
+         return;
+    case aconst_nullCK:
+         ssaLower(v,SSACONST,0);
+         return;
+    case ldc_stringCK:
+    case newCK:
+         ssaLower(v,SSACONST,1);
+         return;
+    case iaddCK:
+    case isubCK:
+    case imulCK:
+    case inegCK:
+    case i2cCK:
+    case idivCK:
+    case iremCK:
+         for (k=0; k<i->argc; k++) {
+             if (ssastate[i->args[k]]==SSABOTTOM) {
+                ssaLower(v,SSABOTTOM,0);
+                return;
+             }
+             if (ssastate[i->args[k]]==SSATOP) return;
+         }
+         a = ssaconst[i->args[0]];
+         b = i->argc>1 ? ssaconst[i->args[1]] : 0;
+         if (ssaFold(i->kind,a,b,&r)) ssaLower(v,SSACONST,r);
+         else ssaLower(v,SSABOTTOM,0);
+         return;
+    case instanceofCK:
+         if (ssastate[i->args[0]]==SSATOP) return;
+         if (ssastate[i->args[0]]==SSACONST && ssaconst[i->args[0]]==0) {
+            ssaLower(v,SSACONST,0);
+         } else {
+            ssaLower(v,SSABOTTOM,0);
+         }
+         return;
+    case invokenonvirtualCK:
+         /* an initialized object */
+         if (s->type[v]==SSAREF && s->def[i->args[0]]!=NULL &&
+             s->def[i->args[0]]->kind==newCK) {
+            ssaLower(v,SSACONST,1);
+            return;
+         }
+         ssaLower(v,SSABOTTOM,0);
+         return;
+    default:
+         ssaLower(v,SSABOTTOM,0);
+         return;
+  }
+}
+
+/* 1 if v is a constant the stackifier can push: an int or null */
+int ssaPushable(SSA *s, int v)
+{ return ssastate[v]==SSACONST && (s->type[v]==SSAINT || ssaconst[v]==0);
+}
+
+/* turns i into the push of the constant its value is known to be */
+void ssaMakeConstant(SSA *s, SSAINSTR *i)
+{ if (s->type[i->result]==SSAINT) {
+     i->kind = ldc_intCK;
+     i->code = makeCODEldc_int(ssaconst[i->result],NULL);
+  } else {
+     i->kind = aconst_nullCK;
+     i->code = makeCODEaconst_null(NULL);
+  }
+  i->argc = 0;
+  i->carried = 0;
+}
+
+/* Rewrites the branch ending block j that is known to go one way */
+int ssaResolve(SSA *s, int j, SSAINSTR **p)
+{ SSABLOCK *b;
+  SSAINSTR *i, *g;
+  int d;
+  b = &s->blocks[j];
+  i = *p;
+  d = ssaDecide(i);
+  if (d<0) return 0;
+  if (d) {
+     g = ssaInstr(gotoCK,makeCODEgoto(codeinfoInt(i->code),NULL),i->carried,j);
+     g->carried = i->carried;
+     memcpy(g->args,i->args,i->carried*sizeof(int));
+     *p = g;
+     if (b->fall==b->target) b->fall = -1;
+     else ssaRemoveEdge(s,j,b->fall);
+     return 1;
+  }
+  if (b->fall!=b->target) ssaRemoveEdge(s,j,b->target);
+  b->target = -1;
+  if (i->carried>0) {
+     i->kind = SSAEXIT;
+     i->code = NULL;
+     i->argc = i->carried;
+  } else {
+     *p = NULL;
+  }
+  return 1;
+}
+
+/* Sparse conditional constant propagation over the executable edges;
+ * folds the values and branches it decides and removes the blocks it
+ * never reaches.
+ */
+int ssaConstants(SSA *s)
+{ SSABLOCK *b;
+  SSAINSTR *i, **p, *head;
+  int j, k, t, v, folded;
+  ssastate = Malloc((s->valuec+1)*sizeof(int));
+  ssaconst = Malloc((s->valuec+1)*sizeof(int));
+  ssaexec = Malloc(s->blockc+1);
+  ssaexecfall = Malloc(s->blockc+1);
+  ssaexectarget = Malloc(s->blockc+1);
+  for (v=0; v<s->valuec; v++) {
+      ssastate[v] = v==SSAUNDEF || s->formal[v]!=-1 ? SSABOTTOM : SSATOP;
+      ssaconst[v] = 0;
+  }
+  for (j=0; j<s->blockc; j++) ssaexec[j] = ssaexecfall[j] = ssaexectarget[j] = 0;
+  ssaexec[0] = ssaexecfall[0] = 1;
+  ssaexec[1] = 1;
+  do {
+    ssachange = 0;
+    for (j=1; j<s->blockc; j++) {
+        b = &s->blocks[j];
+        if (!ssaexec[j] || !b->live) continue;
+        for (i=b->phis; i!=NULL; i=i->next) {
+            if (i->carried) {
+               ssaLower(i->result,SSABOTTOM,0);
+               continue;
+            }
+            for (k=0; k<i->argc; k++) {
+                v = i->args[k];
+                if (!ssaEdgeExecutable(s,b->preds[k],j)) continue;
+                ssaLower(i->result,ssastate[v],ssaconst[v]);
+            }
+        }
+        for (i=b->first; i!=NULL; i=i->next) ssaEvaluate(s,i);
+        i = ssaTerminator(b);
+        if (i!=NULL && i->kind>=0 && (codeinfo[i->kind].flags&CICONDITIONAL)) {
+           t = ssaDecide(i);
+           if (t==-2) continue;
+           if (t!=0) ssaReach(&ssaexectarget[j],b->target);
+           if (t!=1) ssaReach(&ssaexecfall[j],b->fall);
+        } else {
+           if (b->target!=-1) ssaReach(&ssaexectarget[j],b->target);
+           if (b->fall!=-1) ssaReach(&ssaexecfall[j],b->fall);
+        }
+    }
+  } while (ssachange);
+
+  folded = 0;
+  for (j=1; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      if (!b->live || ssaexec[j]) continue;
+      while (b->succc>0) ssaRemoveEdge(s,j,b->succs[0]);
+      b->live = 0;
+      b->phis = b->first = NULL;
+      folded++;
+  }
+  for (j=1; j<s->blockc; j++) {
+      b = &s->blocks[j];
+      if (!b->live) continue;
+      for (p=&b->first; *p!=NULL && (*p)->next!=NULL; p=&(*p)->next);
+      if (*p!=NULL && (*p)->kind>=0 &&
+          (codeinfo[(*p)->kind].flags&CICONDITIONAL)) {
+         folded += ssaResolve(s,j,p);
+      }
+      head = NULL;
+      p = &b->phis;
+      while (*p!=NULL) {
+        i = *p;
+        if (i->carried || !ssaPushable(s,i->result)) {
+           p = &i->next;
+           continue;
+        }
+        *p = i->next;
+        ssaMakeConstant(s,i);
+        i->next = head;
+        head = i;
+        folded++;
+      }
+      for (i=b->first; i!=NULL; i=i->next) {
+          if (i->result<0 || i->kind==ldc_intCK || i->kind==aconst_nullCK ||
+              !ssaPushable(s,i->result) || !ssaPure(s,i)) continue;
+          ssaMakeConstant(s,i);
+          folded++;
+      }
+      if (head!=NULL) {
+         for (i=head; i->next!=NULL; i=i->next);
+         i->next = b->first;
+         b->first = head;
+      }
+  }
+  ssafolded += folded;
+  return folded;
+}
+
+/* a value is only computed again from another local if that saves at
+ * least this many instructions
+ */
+#define SSAWEIGHT 4
+
+int ssaNumberable(SSAINSTR *i)
+{ if (i->result<0) return 0;
+  switch (i->kind) {
+    case iaddCK:
+    case isubCK:
+    case imulCK:
+    case inegCK:
+    case i2cCK:
+    case idivCK:
+    case iremCK:
+    case instanceofCK:
+         return 1;
+    default:
+         return 0;
+  }
+}
+
+int ssaSame(SSAINSTR *a, SSAINSTR *b)
+{ int k;
+  if (a->kind!=b->kind || a->argc!=b->argc) return 0;
+  if (a->kind==instanceofCK &&
+      strcmp(a->code->val.instanceofC,b->code->val.instanceofC)!=0) return 0;
+  if ((a->kind==iaddCK || a->kind==imulCK) &&
+      a->args[0]==b->args[1] && a->args[1]==b->args[0]) return 1;
+  for (k=0; k<a->argc; k++) {
+      if (a->args[k]!=b->args[k]) return 0;
+  }
+  return 1;
+}
+
+/* the instructions saved by not computing i again */
+int ssaWeight(SSA *s, SSAINSTR *i)
+{ SSAINSTR *d;
+  int w, k;
+  w = 1;
+  for (k=0; k<i->argc; k++) {
+      d = s->def[i->args[k]];
+      if (d!=NULL && ssaNumberable(d) && s->uses[i->args[k]]==1) {
+         w += ssaWeight(s,d);
+      } else {
+         w++;
+      }
+  }
+  return w;
+}
+
+SSAINSTR **ssatable;
+int ssatablec;
+
+int ssaNumberBlock(SSA *s, int j, int *first, int *sibling)
+{ SSAINSTR *i, **p;
+  int mark, k, c, n;
+  n = 0;
+  mark = ssatablec;
+  p = &s->blocks[j].first;
+  while (*p!=NULL) {
+    i = *p;
+    if (ssaNumberable(i)) {
+       for (k=ssatablec-1; k>=0 && !ssaSame(ssatable[k],i); k--);
+       if (k>=0 && ssaWeight(s,i)>=SSAWEIGHT) {
+          ssaReplace(s,i->result,ssatable[k]->result);
+          s->def[i->result] = NULL;
+          *p = i->next;
+          n++;
+          continue;
+       }
+       if (k<0) ssatable[ssatablec++] = i;
+    }
+    p = &i->next;
+  }
+  for (c=first[j]; c!=-1; c=sibling[c]) n += ssaNumberBlock(s,c,first,sibling);
+  ssatablec = mark;
+  return n;
+}
+
+/* Value numbering over the dominator tree: an expression computed again
+ * where an equal one dominates it takes that one's value.  Phis of one
+ * block with the same args are merged.
+ */
+int ssaNumber(SSA *s)
+{ SSAINSTR *i, *q, **p;
+  int *first, *sibling, j, k, n, size;
+  ssaDominators(s);
+  ssaCount(s);
+  first = Malloc((s->blockc+1)*sizeof(int));
+  sibling = Malloc((s->blockc+1)*sizeof(int));
+  n = size = 0;
+  for (j=0; j<s->blockc; j++) first[j] = sibling[j] = -1;
+  for (j=s->blockc-1; j>0; j--) {
+      if (!s->blocks[j].live || s->blocks[j].idom<0) continue;
+      sibling[j] = first[s->blocks[j].idom];
+      first[s->blocks[j].idom] = j;
+  }
+  for (j=1; j<s->blockc; j++) {
+      for (i=s->blocks[j].phis; i!=NULL; i=i->next) {
+          if (i->carried) continue;
+          p = &i->next;
+          while (*p!=NULL) {
+            q = *p;
+            for (k=0; k<i->argc && i->args[k]==q->args[k]; k++);
+            if (q->carried || k<i->argc) {
+               p = &q->next;
+               continue;
+            }
+            *p = q->next;
+            ssaReplace(s,q->result,i->result);
+            s->def[q->result] = NULL;
+            n++;
+          }
+      }
+      for (i=s->blocks[j].first; i!=NULL; i=i->next) size++;
+  }
+  ssatable = Malloc((size+1)*sizeof(SSAINSTR *));
+  ssatablec = 0;
+  n += ssaNumberBlock(s,0,first,sibling);
+  ssanumbered += n;
+  return n;
+}
+
+void ssaMark(char *used, int *work, int *n, int v)
+{ if (!used[v]) {
+     used[v] = 1;
+     work[(*n)++] = v;
+  }
+}
+
+/* Removes the phis and pure instructions whose values are never used.
+ * Whether an idiv or irem is pure depends on the def of its divisor, so
+ * every instruction is classified before anything is removed.
+ */
+int ssaDead(SSA *s)
+{ SSAINSTR *i, **p, *d;
+  char *used, *pure;
+  int *work, n, j, k, v, removed;
+  used = Malloc(s->valuec+1);
+  pure = Malloc(s->valuec+1);
+  work = Malloc((s->valuec+1)*sizeof(int));
+  memset(used,0,s->valuec+1);
+  memset(pure,0,s->valuec+1);
+  n = 0;
+  for (j=1; j<s->blockc; j++) {
+      for (i=s->blocks[j].first; i!=NULL; i=i->next) {
+          if (i->result>=0 && ssaPure(s,i)) {
+             pure[i->result] = 1;
+             continue;
+          }
+          for (k=0; k<i->argc; k++) ssaMark(used,work,&n,i->args[k]);
+      }
+  }
+  while (n>0) {
+    v = work[--n];
+    d = s->def[v];
+    if (d==NULL) continue;
+    for (k=0; k<d->argc; k++) ssaMark(used,work,&n,d->args[k]);
+  }
+  removed = 0;
+  for (j=1; j<s->blockc; j++) {
+      p = &s->blocks[j].phis;
+      while (*p!=NULL) {
+        i = *p;
+        if (i->carried || used[i->result]) {
+           p = &i->next;
+           continue;
+        }
+        *p = i->next;
+        s->def[i->result] = NULL;
+        removed++;
+      }
+      p = &s->blocks[j].first;
+      while (*p!=NULL) {
+        i = *p;
+        if (i->result<0 || used[i->result] || !pure[i->result]) {
+           p = &i->next;
+           continue;
+        }
+        *p = i->next;
+        s->def[i->result] = NULL;
+        removed++;
+      }
+  }
+  ssaremoved += removed;
+  return removed;
+}
+
+void ssaOptimize(SSA *s)
+{ int change;
+  do {
+    change = ssaCopies(s);
+    change += ssaConstants(s);
+    change += ssaNumber(s);
+    change += ssaDead(s);
+  } while (change);
+}
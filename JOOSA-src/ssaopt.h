@@ -0,0 +1,29 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* The optimizations run on the SSA form of ssa.h: copy propagation
+ * through phis, sparse conditional constant propagation, value numbering
+ * over the dominator tree and the removal of unused values.  The counts
+ * are only kept for methods whose rewritten code is kept.
+ */
+
+extern int ssafolded, ssanumbered, ssaremoved;
+
+int ssaCopies(struct SSA *s);
+int ssaConstants(struct SSA *s);
+int ssaNumber(struct SSA *s);
+int ssaDead(struct SSA *s);
+void ssaOptimize(struct SSA *s);
+void ssaSave();
+void ssaRestore();
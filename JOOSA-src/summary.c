@@ -0,0 +1,358 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "symbol.h"
+#include "flow.h"
+#include "cha.h"
+#include "codeinfo.h"
+#include "cache.h"
+#include "summary.h"
+
+/* Library methods that a call may be summarized by, when no class of the
+ * program overrides them.  Purity assumes a non-null receiver, so a method
+ * such as String.concat, which throws on a null argument, is not pure.
+ */
+typedef struct SUMMARYNOTE {
+  char *invoke;
+  int summary;
+} SUMMARYNOTE;
+
+SUMMARYNOTE summarynotes[] = {
+  {"java/lang/Boolean/booleanValue()Z",                SUMPURE},
+  {"java/lang/Character/charValue()C",                 SUMPURE},
+  {"java/lang/Character/toString()Ljava/lang/String;", SUMPURE|SUMNONNULL},
+  {"java/lang/Integer/intValue()I",                    SUMPURE},
+  {"java/lang/Integer/toString()Ljava/lang/String;",   SUMPURE|SUMNONNULL},
+  {"java/lang/Object/toString()Ljava/lang/String;",    SUMNONNULL},
+  {"java/lang/String/concat(Ljava/lang/String;)Ljava/lang/String;", SUMNONNULL},
+  {"java/lang/String/equals(Ljava/lang/Object;)Z",     SUMPURE},
+  {"java/lang/String/hashCode()I",                     SUMPURE},
+  {"java/lang/String/length()I",                       SUMPURE},
+  {"java/lang/String/substring(II)Ljava/lang/String;", SUMNONNULL},
+  {"java/lang/String/toString()Ljava/lang/String;",    SUMPURE|SUMNONNULL},
+  {"java/lang/String/trim()Ljava/lang/String;",        SUMPURE|SUMNONNULL},
+  {"java/lang/StringBuffer/append(I)Ljava/lang/StringBuffer;", SUMNONNULL},
+  {"java/lang/StringBuffer/append(Ljava/lang/Object;)Ljava/lang/StringBuffer;", SUMNONNULL},
+  {"java/lang/StringBuffer/append(Ljava/lang/String;)Ljava/lang/StringBuffer;", SUMNONNULL},
+  {"java/lang/StringBuffer/toString()Ljava/lang/String;", SUMPURE|SUMNONNULL},
+  {"java/util/Vector/size()I",                         SUMPURE},
+  {NULL, 0}
+};
+
+/* A value is UNKNOWN, NONNULL, NULLVALUE, or the constant pushed by
+ * summaryconstants[v-CONSTANT].
+ */
+#define UNKNOWN 0
+#define NONNULL 1
+#define NULLVALUE 2
+#define CONSTANT 3
+
+CODE **summaryconstants;
+int summaryconstantcount, summaryconstantsize;
+
+int summaryremoved, summaryfolded;
+
+int summarySame(CODE *a, CODE *b)
+{ if (a==NULL || b==NULL) return a==b;
+  if (a->kind!=b->kind) return 0;
+  if (a->kind==ldc_stringCK) return strcmp(a->val.ldc_stringC,b->val.ldc_stringC)==0;
+  if (a->kind==ldc_intCK) return a->val.ldc_intC==b->val.ldc_intC;
+  return 1;
+}
+
+/* the value pushed by c, one of ldc_int, ldc_string and aconst_null */
+int summaryValue(CODE *c)
+{ CODE **t;
+  int i;
+  if (c->kind==aconst_nullCK) return NULLVALUE;
+  for (i=0; i<summaryconstantcount; i++) {
+      if (summarySame(summaryconstants[i],c)) return CONSTANT+i;
+  }
+  if (summaryconstantcount==summaryconstantsize) {
+     summaryconstantsize = 2*summaryconstantsize+16;
+     t = Malloc(summaryconstantsize*sizeof(CODE *));
+     for (i=0; i<summaryconstantcount; i++) t[i] = summaryconstants[i];
+     summaryconstants = t;
+  }
+  /* a copy, as the optimizer may rewrite c in place */
+  summaryconstants[summaryconstantcount] = NEW(CODE);
+  *summaryconstants[summaryconstantcount] = *c;
+  summaryconstants[summaryconstantcount]->next = NULL;
+  return CONSTANT+summaryconstantcount++;
+}
+
+CODE *summaryConstant(int v)
+{ if (v==NULLVALUE) return makeCODEaconst_null(NULL);
+  if (v>=CONSTANT) return summaryconstants[v-CONSTANT];
+  return NULL;
+}
+
+int summaryNonnull(int v)
+{ return v==NONNULL || (v>=CONSTANT && summaryconstants[v-CONSTANT]->kind==ldc_stringCK);
+}
+
+int summaryJoin(int a, int b)
+{ if (a==b) return a;
+  if (summaryNonnull(a) && summaryNonnull(b)) return NONNULL;
+  return UNKNOWN;
+}
+
+/****************  calls  ****************/
+
+int summaryNote(char *invoke, CLASS *class, char *name)
+{ IMPLEMENTATION *i;
+  SUMMARYNOTE *n;
+  for (i=chaImplementations(name); i!=NULL; i=i->next) {
+      if (subClass(i->class,class)) return 0;
+  }
+  for (n=summarynotes; n->invoke!=NULL; n++) {
+      if (strcmp(n->invoke,invoke)==0) return n->summary;
+  }
+  return 0;
+}
+
+/* The summary of a call, the meet of those of every method it may reach.
+ * Sets *constant if that includes SUMCONSTANT.
+ */
+int summaryCall(CODE *c, CODE **constant)
+{ CLASS *class;
+  IMPLEMENTATION *targets, *t;
+  SYMBOL *s;
+  char *invoke, *name;
+  int summary;
+  *constant = NULL;
+  if (c->kind!=invokevirtualCK && c->kind!=invokenonvirtualCK) return 0;
+  invoke = codeinfoString(c);
+  if (!chaSplit(invoke,&class,&name) || strcmp(name,"<init>")==0) return 0;
+  if (c->kind==invokenonvirtualCK) {
+     s = lookupHierarchy(name,class);
+     if (s==NULL || s->kind!=methodSym) return 0;
+     class = lookupHierarchyClass(name,class);
+     if (class->external) return summaryNote(invoke,class,name);
+     *constant = s->val.methodS->constant;
+     return s->val.methodS->summary;
+  }
+  if (class->external) return summaryNote(invoke,class,name);
+  if (chaTargets(class,name,&targets)<=0) return 0;
+  summary = SUMPURE|SUMNONNULL|SUMCONSTANT;
+  *constant = targets->method->constant;
+  for (t=targets; t!=NULL; t=t->next) {
+      summary &= t->method->summary;
+      if (!summarySame(t->method->constant,*constant)) summary &= ~SUMCONSTANT;
+  }
+  if (!(summary&SUMCONSTANT)) *constant = NULL;
+  return summary;
+}
+
+/****************  the analysis of one method  ****************/
+
+void summaryTransfer(FLOW *f, int i, int *fall, int *taken)
+{ CODE *c, *constant;
+  int h, summary;
+  c = f->code[i];
+  h = FLOWHEIGHT(fall);
+  switch (c->kind) {
+    case ldc_intCK:
+    case ldc_stringCK:
+    case aconst_nullCK:
+         FLOWSTACK(f,fall,h) = summaryValue(c);
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case newCK:
+         FLOWSTACK(f,fall,h) = NONNULL;
+         FLOWHEIGHT(fall) = h+1;
+         break;
+    case invokevirtualCK:
+    case invokenonvirtualCK:
+         flowDefault(f,i,fall,UNKNOWN);
+         if (!codeinfoPushes(c)) break;
+         summary = summaryCall(c,&constant);
+         if (summary&SUMCONSTANT) {
+            FLOWTOP(f,fall,1) = summaryValue(constant);
+         } else if (summary&SUMNONNULL) {
+            FLOWTOP(f,fall,1) = NONNULL;
+         }
+         break;
+    default:
+         flowDefault(f,i,fall,UNKNOWN);
+         break;
+  }
+  memcpy(taken,fall,f->width*sizeof(int));
+}
+
+FLOW *summaryFlow(CODE *c, int isstatic, int localslimit)
+{ FLOW *f;
+  int *s;
+  f = flowCODE(c,localslimit);
+  s = flowEntry(f,UNKNOWN);
+  if (!isstatic) FLOWLOCAL(f,s,0) = NONNULL;
+  flowSolve(f,s,summaryJoin,summaryTransfer);
+  return f;
+}
+
+/* 1 if the call at i may be left out when its result is not needed */
+int summaryRemovable(FLOW *f, int i, int *s)
+{ CODE *constant;
+  return (summaryCall(f->code[i],&constant)&SUMPURE) &&
+         summaryNonnull(FLOWTOP(f,s,codeinfoPops(f->code[i])));
+}
+
+/* computes the summary of m from those of the methods it calls,
+ * returns 1 if it changed
+ */
+int summaryMETHODbody(METHOD *m)
+{ FLOW *f;
+  CODE *c, *constant;
+  int *s, i, pure, result, summary;
+  f = summaryFlow(m->opcodes,m->modifier==staticMod,m->localslimit);
+  pure = 1;
+  result = -1;
+  for (i=0; i<f->count; i++) {
+      s = flowIn(f,i);
+      if (s==NULL) continue;
+      c = f->code[i];
+      switch (c->kind) {
+        case putfieldCK:
+        case newCK:
+        case checkcastCK:
+        case idivCK:
+        case iremCK:
+             pure = 0;
+             break;
+        case getfieldCK:
+             if (!summaryNonnull(FLOWTOP(f,s,1))) pure = 0;
+             break;
+        case invokevirtualCK:
+        case invokenonvirtualCK:
+             if (!summaryRemovable(f,i,s)) pure = 0;
+             break;
+        case ireturnCK:
+        case areturnCK:
+             result = result==-1 ? FLOWTOP(f,s,1) : summaryJoin(result,FLOWTOP(f,s,1));
+             break;
+        default:
+             break;
+      }
+      /* a loop might not terminate */
+      if (f->target[i]!=-1 && f->target[i]<=i) pure = 0;
+  }
+  summary = pure ? SUMPURE : 0;
+  constant = NULL;
+  if (result!=-1 && summaryNonnull(result) && m->returntype->kind==refK) {
+     summary |= SUMNONNULL;
+  }
+  if (result!=-1 && (constant = summaryConstant(result))!=NULL) {
+     summary |= SUMCONSTANT;
+  }
+  if (summary==m->summary && summarySame(constant,m->constant)) return 0;
+  m->summary = summary;
+  m->constant = constant;
+  return 1;
+}
+
+int summaryMETHOD(METHOD *m)
+{ int change = 0;
+  for (; m!=NULL; m=m->next) {
+      if (m->opcodes!=NULL) change |= summaryMETHODbody(m);
+  }
+  return change;
+}
+
+int summaryCLASSFILE(CLASSFILE *c)
+{ int change = 0;
+  for (; c!=NULL; c=c->next) {
+      if (!c->class->external) change |= summaryMETHOD(c->class->methods);
+  }
+  return change;
+}
+
+/* Every summary starts out empty and only grows as those of the callees
+ * do, so a recursive method is never pure.
+ */
+void summaryPROGRAM(PROGRAM *p)
+{ PROGRAM *q;
+  CLASSFILE *c;
+  METHOD *m;
+  char s[48];
+  int change, pure, nonnull, constant;
+  do {
+    change = 0;
+    for (q=p; q!=NULL; q=q->next) change |= summaryCLASSFILE(q->classfile);
+  } while (change);
+
+  pure = nonnull = constant = 0;
+  for (q=p; q!=NULL; q=q->next) {
+      for (c=q->classfile; c!=NULL; c=c->next) {
+          if (c->class->external) continue;
+          for (m=c->class->methods; m!=NULL; m=m->next) {
+              if (m->summary&SUMPURE) pure++;
+              if (m->summary&SUMNONNULL) nonnull++;
+              if (m->summary&SUMCONSTANT) constant++;
+              /* the code of a caller now depends on the summary */
+              cacheMix(c->class->name);
+              cacheMix(m->name);
+              sprintf(s,"%i %i %i",m->summary,
+                      m->constant==NULL ? -1 : m->constant->kind,
+                      m->constant!=NULL && m->constant->kind==ldc_intCK ?
+                      m->constant->val.ldc_intC : 0);
+              cacheMix(s);
+              if (m->constant!=NULL && m->constant->kind==ldc_stringCK) {
+                 cacheMix(m->constant->val.ldc_stringC);
+              }
+          }
+      }
+  }
+  printf("\nmethod summaries: pure %i, non-null %i, constant %i\n",
+         pure,nonnull,constant);
+}
+
+/****************  use of the summaries  ****************/
+
+/* Replaces calls of pure methods on non-null receivers by pops of their
+ * arguments when the result is not used, and by the result when it is a
+ * constant.
+ */
+int summaryCODE(CODE *c, int isstatic, int localslimit)
+{ FLOW *f;
+  CODE *constant, *r, *p;
+  int *s, i, k, summary, change;
+  f = summaryFlow(c,isstatic,localslimit);
+  change = 0;
+  for (i=0; i<f->count; i++) {
+      s = flowIn(f,i);
+      p = f->code[i];
+      if (s==NULL || (p->kind!=invokevirtualCK && p->kind!=invokenonvirtualCK)) continue;
+      if (!summaryRemovable(f,i,s)) continue;
+      summary = summaryCall(p,&constant);
+      r = p->next;
+      if (!codeinfoPushes(p)) {
+         summaryremoved++;
+      } else if (i+1<f->count && f->code[i+1]->kind==popCK) {
+         f->code[i+1]->kind = nopCK;
+         summaryremoved++;
+      } else if (summary&SUMCONSTANT) {
+         r = NEW(CODE);
+         *r = *constant;
+         r->next = p->next;
+         summaryfolded++;
+      } else {
+         continue;
+      }
+      for (k=codeinfoPops(p); k>0; k--) r = makeCODEpop(r);
+      *p = *r;
+      change = 1;
+  }
+  return change;
+}
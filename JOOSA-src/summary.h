@@ -0,0 +1,32 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Whole-program method summaries.  A method is
+ *   SUMPURE      if a call with a non-null receiver has no effect besides
+ *                its result: it writes no field, allocates nothing, cannot
+ *                throw and terminates;
+ *   SUMNONNULL   if it never returns null;
+ *   SUMCONSTANT  if it always returns the value pushed by m->constant.
+ * Library methods are described by a table in summary.c instead.
+ */
+
+#define SUMPURE 1
+#define SUMNONNULL 2
+#define SUMCONSTANT 4
+
+extern int summaryremoved, summaryfolded;
+
+void summaryPROGRAM(PROGRAM *p);
+int summaryCall(CODE *c, CODE **constant);
+int summaryCODE(CODE *c, int isstatic, int localslimit);
@@ -0,0 +1,854 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "error.h"
+#include "optimize.h"
+#include "codeinfo.h"
+#include "superopt.h"
+#include "cache.h"
+
+#define MASK 0xffffffffUL
+
+/****************  the instructions we reason about  ****************/
+
+/* Only instructions that cannot throw and touch nothing but the stack and
+ * the locals take part, and of those only the ones on ints and references
+ * that are not strings.
+ */
+int superKind(int kind)
+{ if (kind<0 || kind>=CODEKINDS || kind==nopCK) return -1;
+  if (!(codeinfo[kind].flags&CIPURE) || codeinfo[kind].operand==CISTRING) return -1;
+  return kind;
+}
+
+int superLocal(CODE *c)
+{ switch (c->kind) {
+    case iloadCK: return c->val.iloadC;
+    case istoreCK: return c->val.istoreC;
+    case aloadCK: return c->val.aloadC;
+    case astoreCK: return c->val.astoreC;
+    case iincCK: return c->val.iincC.offset;
+    default: return -1;
+  }
+}
+
+/* converts c, numbering its local through locals[0..*nvars);
+ * returns 0 if c is not an instruction we reason about.
+ */
+int superFromCODE(CODE *c, SUPERINSN *s, int *locals, int *nvars)
+{ int k, v;
+  k = superKind(c->kind);
+  if (k==-1) return 0;
+  s->kind = c->kind;
+  s->arg = s->amount = 0;
+  switch (codeinfo[k].operand) {
+    case CILOCAL:
+    case CIIINC:
+         for (v=0; v<*nvars && locals[v]!=superLocal(c); v++);
+         if (v==*nvars) {
+            if (*nvars==SUPERVARS) return 0;
+            locals[(*nvars)++] = superLocal(c);
+         }
+         s->arg = v;
+         if (c->kind==iincCK) s->amount = c->val.iincC.amount;
+         break;
+    case CIINT:
+         s->arg = c->val.ldc_intC;
+         break;
+  }
+  return 1;
+}
+
+CODE *superToCODE(SUPERINSN *s, int *locals, CODE *next)
+{ switch (s->kind) {
+    case i2cCK: return makeCODEi2c(next);
+    case imulCK: return makeCODEimul(next);
+    case inegCK: return makeCODEineg(next);
+    case isubCK: return makeCODEisub(next);
+    case iaddCK: return makeCODEiadd(next);
+    case iincCK: return makeCODEiinc(locals[s->arg],s->amount,next);
+    case iloadCK: return makeCODEiload(locals[s->arg],next);
+    case istoreCK: return makeCODEistore(locals[s->arg],next);
+    case aloadCK: return makeCODEaload(locals[s->arg],next);
+    case astoreCK: return makeCODEastore(locals[s->arg],next);
+    case dupCK: return makeCODEdup(next);
+    case popCK: return makeCODEpop(next);
+    case swapCK: return makeCODEswap(next);
+    case ldc_intCK: return makeCODEldc_int(s->arg,next);
+    case aconst_nullCK: return makeCODEaconst_null(next);
+  }
+  return next;
+}
+
+/* the size in bytes, as emit.c writes it and Jasmin assembles it */
+int superBytes(SUPERINSN *s, int *locals)
+{ CODE c;
+  c.kind = s->kind;
+  switch (codeinfo[s->kind].operand) {
+    case CILOCAL:
+         codeinfoSetInt(&c,locals[s->arg]);
+         break;
+    case CIIINC:
+         c.val.iincC.offset = locals[s->arg];
+         c.val.iincC.amount = s->amount;
+         break;
+    case CIINT:
+         codeinfoSetInt(&c,s->arg);
+         break;
+  }
+  return codeinfoSize(&c);
+}
+
+int superCost(SUPERINSN *s, int n, int *locals)
+{ int i, b;
+  b = 0;
+  for (i=0; i<n; i++) b += superBytes(&s[i],locals);
+  return b;
+}
+
+char *superText(SUPERINSN *s, int n)
+{ char *t, buf[64];
+  int i, k;
+  t = Malloc(n*64+1);
+  t[0] = '\0';
+  for (i=0; i<n; i++) {
+      k = superKind(s[i].kind);
+      switch (codeinfo[k].operand) {
+        case CINONE: sprintf(buf,"%s",codeinfo[k].name); break;
+        case CILOCAL: sprintf(buf,"%s v%i",codeinfo[k].name,s[i].arg); break;
+        case CIIINC: sprintf(buf,"%s v%i %i",codeinfo[k].name,s[i].arg,s[i].amount); break;
+        case CIINT: sprintf(buf,"%s %i",codeinfo[k].name,s[i].arg); break;
+      }
+      if (i>0) strcat(t," ; ");
+      strcat(t,buf);
+  }
+  return t;
+}
+
+/****************  polynomials over the inputs  ****************/
+
+/* Symbolic values are polynomials modulo 2^32 in canonical form, whose
+ * atoms are the inputs, null and applications of i2c.  Equal polynomials
+ * denote equal functions, so equal forms prove equivalence; anything too
+ * large to represent is taken to be different from everything.
+ */
+
+#define MAXMONO 32
+#define MAXDEG 4
+#define NULLATOM 15
+#define VARATOM 16
+#define CHARATOM 32
+#define MAXCHARS 32
+
+typedef struct MONO {
+  unsigned long coef;
+  int deg;
+  int atom[MAXDEG];
+} MONO;
+
+typedef struct POLY {
+  int n;
+  int overflow;
+  MONO m[MAXMONO];
+} POLY;
+
+POLY *superchars[MAXCHARS];
+int supercharcount;
+
+POLY *polyNew()
+{ POLY *p;
+  p = NEW(POLY);
+  p->n = 0;
+  p->overflow = 0;
+  return p;
+}
+
+int monoCompare(MONO *a, MONO *b)
+{ int i;
+  if (a->deg!=b->deg) return a->deg-b->deg;
+  for (i=0; i<a->deg; i++) {
+      if (a->atom[i]!=b->atom[i]) return a->atom[i]-b->atom[i];
+  }
+  return 0;
+}
+
+void polyAddMono(POLY *p, MONO *x)
+{ int i, j, c;
+  if (p->overflow || (x->coef&MASK)==0) return;
+  for (i=0; i<p->n; i++) {
+      c = monoCompare(&p->m[i],x);
+      if (c==0) {
+         p->m[i].coef = (p->m[i].coef+x->coef)&MASK;
+         if (p->m[i].coef==0) {
+            for (j=i; j+1<p->n; j++) p->m[j] = p->m[j+1];
+            p->n--;
+         }
+         return;
+      }
+      if (c>0) break;
+  }
+  if (p->n==MAXMONO) {
+     p->overflow = 1;
+     return;
+  }
+  for (j=p->n; j>i; j--) p->m[j] = p->m[j-1];
+  p->m[i] = *x;
+  p->m[i].coef &= MASK;
+  p->n++;
+}
+
+POLY *polyConst(unsigned long c)
+{ POLY *p;
+  MONO x;
+  p = polyNew();
+  x.coef = c&MASK;
+  x.deg = 0;
+  polyAddMono(p,&x);
+  return p;
+}
+
+POLY *polyAtom(int a)
+{ POLY *p;
+  MONO x;
+  p = polyNew();
+  x.coef = 1;
+  x.deg = 1;
+  x.atom[0] = a;
+  polyAddMono(p,&x);
+  return p;
+}
+
+POLY *polyAdd(POLY *a, POLY *b, int negate)
+{ POLY *p;
+  MONO x;
+  int i;
+  p = polyNew();
+  *p = *a;
+  p->overflow = a->overflow || b->overflow;
+  for (i=0; i<b->n; i++) {
+      x = b->m[i];
+      if (negate) x.coef = (0UL-x.coef)&MASK;
+      polyAddMono(p,&x);
+  }
+  return p;
+}
+
+POLY *polyMul(POLY *a, POLY *b)
+{ POLY *p;
+  MONO x;
+  int i, j, k, l;
+  p = polyNew();
+  p->overflow = a->overflow || b->overflow;
+  for (i=0; i<a->n && !p->overflow; i++) {
+      for (j=0; j<b->n && !p->overflow; j++) {
+          if (a->m[i].deg+b->m[j].deg>MAXDEG) {
+             p->overflow = 1;
+             break;
+          }
+          x.coef = (a->m[i].coef*b->m[j].coef)&MASK;
+          x.deg = 0;
+          k = l = 0;
+          while (k<a->m[i].deg || l<b->m[j].deg) {
+            if (l==b->m[j].deg ||
+                (k<a->m[i].deg && a->m[i].atom[k]<=b->m[j].atom[l])) {
+               x.atom[x.deg++] = a->m[i].atom[k++];
+            } else {
+               x.atom[x.deg++] = b->m[j].atom[l++];
+            }
+          }
+          polyAddMono(p,&x);
+      }
+  }
+  return p;
+}
+
+int polyEqual(POLY *a, POLY *b)
+{ int i;
+  if (a->overflow || b->overflow || a->n!=b->n) return 0;
+  for (i=0; i<a->n; i++) {
+      if (a->m[i].coef!=b->m[i].coef || monoCompare(&a->m[i],&b->m[i])!=0) return 0;
+  }
+  return 1;
+}
+
+POLY *polyChar(POLY *a)
+{ POLY *p;
+  int i;
+  if (a->overflow) return a;
+  if (a->n==0) return a;
+  if (a->n==1 && a->m[0].deg==0) return polyConst(a->m[0].coef&0xffff);
+  if (a->n==1 && a->m[0].deg==1 && a->m[0].coef==1 &&
+      a->m[0].atom[0]>=CHARATOM) return a;
+  for (i=0; i<supercharcount; i++) {
+      if (polyEqual(superchars[i],a)) return polyAtom(CHARATOM+i);
+  }
+  if (supercharcount==MAXCHARS) {
+     p = polyNew();
+     p->overflow = 1;
+     return p;
+  }
+  superchars[supercharcount] = a;
+  return polyAtom(CHARATOM+supercharcount++);
+}
+
+/****************  evaluation  ****************/
+
+/* Every window is run on NVEC vectors of pseudo-random inputs and, when
+ * those agree, symbolically.  Inputs are the SUPERMAX or fewer values below
+ * the stack top that the window consumes, and the initial values of its
+ * locals.
+ */
+
+#define NVEC 3
+#define SUPERSTACK (3*SUPERMAX)
+
+#define SUPERINT 1
+#define SUPERREF 2
+#define SUPERANY 3
+
+typedef struct VALUE {
+  int type;
+  int input;               /* the input this is a copy of, or -1 */
+  unsigned long v[NVEC];
+  POLY *p;                 /* only when evaluating symbolically */
+} VALUE;
+
+typedef struct STATE {
+  int top;                 /* values on the stack, inputs included */
+  VALUE stack[SUPERSTACK];
+  VALUE var[SUPERVARS];
+  int written[SUPERVARS];
+} STATE;
+
+int superdepth, supernvars;
+int supervartype[SUPERVARS], superinitread[SUPERVARS];
+int superinputtype[SUPERSTACK];
+unsigned long superrandom[NVEC][SUPERSTACK+SUPERVARS];
+
+void superSeed()
+{ unsigned long r;
+  int k, i;
+  r = 12345;
+  for (k=0; k<NVEC; k++) {
+      for (i=0; i<SUPERSTACK+SUPERVARS; i++) {
+          r = (r*1103515245UL+12345UL)&MASK;
+          superrandom[k][i] = (r>>8)^(r<<13);
+          superrandom[k][i] &= MASK;
+      }
+  }
+}
+
+void superInitial(STATE *s, int symbolic)
+{ int i, k;
+  s->top = superdepth;
+  for (i=0; i<superdepth; i++) {
+      s->stack[i].type = superinputtype[i];
+      s->stack[i].input = i;
+      for (k=0; k<NVEC; k++) s->stack[i].v[k] = superrandom[k][i];
+      s->stack[i].p = symbolic ? polyAtom(1+i) : NULL;
+  }
+  for (i=0; i<supernvars; i++) {
+      s->var[i].type = supervartype[i];
+      s->var[i].input = -1;
+      for (k=0; k<NVEC; k++) s->var[i].v[k] = superrandom[k][SUPERSTACK+i];
+      s->var[i].p = symbolic ? polyAtom(VARATOM+i) : NULL;
+      s->written[i] = 0;
+  }
+}
+
+/* pops a value of the given type.  When infer is set an input of unknown
+ * type gets that type; otherwise such an input may only be moved around.
+ */
+VALUE *superPop(STATE *s, int type, int infer)
+{ VALUE *x;
+  if (s->top==0) return NULL;
+  x = &s->stack[--s->top];
+  if (type==SUPERANY || x->type==type) return x;
+  if (x->type!=SUPERANY || !infer) return NULL;
+  if (x->input>=0) superinputtype[x->input] = type;
+  x->type = type;
+  return x;
+}
+
+int superVar(STATE *s, int v, int type, int infer)
+{ if (infer) {
+     if (supervartype[v]==0) supervartype[v] = type;
+     if (!s->written[v]) superinitread[v] = 1;
+  }
+  if (supervartype[v]!=type) return 0;
+  return s->written[v] || superinitread[v];
+}
+
+int superStep(STATE *s, SUPERINSN *x, int infer, int symbolic)
+{ VALUE a, b, *p;
+  int k;
+  switch (x->kind) {
+    case iaddCK:
+    case isubCK:
+    case imulCK:
+         if ((p = superPop(s,SUPERINT,infer))==NULL) return 0;
+         b = *p;
+         if ((p = superPop(s,SUPERINT,infer))==NULL) return 0;
+         a = *p;
+         for (k=0; k<NVEC; k++) {
+             if (x->kind==iaddCK) a.v[k] = (a.v[k]+b.v[k])&MASK;
+             if (x->kind==isubCK) a.v[k] = (a.v[k]-b.v[k])&MASK;
+             if (x->kind==imulCK) a.v[k] = (a.v[k]*b.v[k])&MASK;
+         }
+         if (symbolic) {
+            if (x->kind==imulCK) a.p = polyMul(a.p,b.p);
+            else a.p = polyAdd(a.p,b.p,x->kind==isubCK);
+         }
+         a.input = -1;
+         s->stack[s->top++] = a;
+         break;
+    case inegCK:
+    case i2cCK:
+         if ((p = superPop(s,SUPERINT,infer))==NULL) return 0;
+         a = *p;
+         for (k=0; k<NVEC; k++) {
+             if (x->kind==inegCK) a.v[k] = (0UL-a.v[k])&MASK;
+             else a.v[k] &= 0xffff;
+         }
+         if (symbolic) {
+            if (x->kind==inegCK) a.p = polyAdd(polyConst(0),a.p,1);
+            else a.p = polyChar(a.p);
+         }
+         a.input = -1;
+         s->stack[s->top++] = a;
+         break;
+    case iloadCK:
+    case aloadCK:
+         if (!superVar(s,x->arg,x->kind==iloadCK ? SUPERINT : SUPERREF,infer)) return 0;
+         if (s->top==SUPERSTACK) return 0;
+         s->stack[s->top++] = s->var[x->arg];
+         break;
+    case istoreCK:
+    case astoreCK:
+         if (infer && supervartype[x->arg]==0) {
+            supervartype[x->arg] = x->kind==istoreCK ? SUPERINT : SUPERREF;
+         }
+         if (supervartype[x->arg]!=(x->kind==istoreCK ? SUPERINT : SUPERREF)) return 0;
+         if ((p = superPop(s,supervartype[x->arg],infer))==NULL) return 0;
+         s->var[x->arg] = *p;
+         s->written[x->arg] = 1;
+         break;
+    case iincCK:
+         if (!superVar(s,x->arg,SUPERINT,infer)) return 0;
+         for (k=0; k<NVEC; k++) {
+             s->var[x->arg].v[k] = (s->var[x->arg].v[k]+(unsigned long)x->amount)&MASK;
+         }
+         if (symbolic) {
+            s->var[x->arg].p = polyAdd(s->var[x->arg].p,polyConst((unsigned long)x->amount),0);
+         }
+         s->var[x->arg].input = -1;
+         s->written[x->arg] = 1;
+         break;
+    case ldc_intCK:
+    case aconst_nullCK:
+         if (s->top==SUPERSTACK) return 0;
+         a.type = x->kind==ldc_intCK ? SUPERINT : SUPERREF;
+         a.input = -1;
+         for (k=0; k<NVEC; k++) {
+             a.v[k] = x->kind==ldc_intCK ? ((unsigned long)x->arg)&MASK : 0;
+         }
+         if (symbolic) {
+            a.p = x->kind==ldc_intCK ? polyConst((unsigned long)x->arg) : polyAtom(NULLATOM);
+         }
+         s->stack[s->top++] = a;
+         break;
+    case dupCK:
+         if (s->top==0 || s->top==SUPERSTACK) return 0;
+         s->stack[s->top] = s->stack[s->top-1];
+         s->top++;
+         break;
+    case popCK:
+         if (s->top==0) return 0;
+         s->top--;
+         break;
+    case swapCK:
+         if (s->top<2) return 0;
+         a = s->stack[s->top-1];
+         s->stack[s->top-1] = s->stack[s->top-2];
+         s->stack[s->top-2] = a;
+         break;
+    default:
+         return 0;
+  }
+  return 1;
+}
+
+int superRun(SUPERINSN *x, int n, STATE *s, int infer, int symbolic)
+{ int i;
+  superInitial(s,symbolic);
+  for (i=0; i<n; i++) {
+      if (!superStep(s,&x[i],infer,symbolic)) return 0;
+  }
+  return 1;
+}
+
+int superSame(STATE *a, STATE *b, int symbolic)
+{ int i, k;
+  if (a->top!=b->top) return 0;
+  for (i=0; i<a->top; i++) {
+      if (a->stack[i].type!=b->stack[i].type) return 0;
+      for (k=0; k<NVEC; k++) {
+          if (a->stack[i].v[k]!=b->stack[i].v[k]) return 0;
+      }
+      if (symbolic && !polyEqual(a->stack[i].p,b->stack[i].p)) return 0;
+  }
+  for (i=0; i<supernvars; i++) {
+      for (k=0; k<NVEC; k++) {
+          if (a->var[i].v[k]!=b->var[i].v[k]) return 0;
+      }
+      if (symbolic && !polyEqual(a->var[i].p,b->var[i].p)) return 0;
+  }
+  return 1;
+}
+
+/****************  the search  ****************/
+
+SUPERINSN superwindow[SUPERMAX];
+int superwindowlength;
+int superlocals[SUPERVARS];
+STATE superfinal, superfinalsym;
+
+SUPERINSN supertemplates[64];
+int supertemplatecount;
+
+SUPERINSN supercand[SUPERMAX], superbest[SUPERMAX];
+int superbestlength, superbestbytes, superfound;
+
+/* sets up the inputs, types and final state of the window;
+ * returns 0 if the window is not well-typed on its own.
+ */
+int superAnalyse()
+{ STATE s;
+  int i, h, k;
+  superdepth = h = 0;
+  for (i=0; i<superwindowlength; i++) {
+      k = superKind(superwindow[i].kind);
+      h -= codeinfo[k].pops;
+      if (-h>superdepth) superdepth = -h;
+      h += codeinfo[k].pushes;
+  }
+  if (superdepth>SUPERMAX) return 0;
+  for (i=0; i<superdepth; i++) superinputtype[i] = SUPERANY;
+  for (i=0; i<supernvars; i++) supervartype[i] = superinitread[i] = 0;
+  supercharcount = 0;
+  if (!superRun(superwindow,superwindowlength,&s,1,0)) return 0;
+  if (!superRun(superwindow,superwindowlength,&superfinal,0,0)) return 0;
+  return superRun(superwindow,superwindowlength,&superfinalsym,0,1);
+}
+
+void superTemplate(int kind, int arg, int amount)
+{ supertemplates[supertemplatecount].kind = kind;
+  supertemplates[supertemplatecount].arg = arg;
+  supertemplates[supertemplatecount].amount = amount;
+  supertemplatecount++;
+}
+
+/* the instructions a replacement may use: the window's locals, its
+ * constants together with -1, 0 and 1, and the arithmetic and stack ones
+ */
+void superTemplates()
+{ int consts[2*SUPERMAX+3], nconsts, hasref;
+  int i, j, v;
+  nconsts = 0;
+  consts[nconsts++] = 0;
+  consts[nconsts++] = 1;
+  consts[nconsts++] = -1;
+  hasref = 0;
+  for (i=0; i<superwindowlength; i++) {
+      v = superwindow[i].kind==ldc_intCK ? superwindow[i].arg :
+          superwindow[i].kind==iincCK ? superwindow[i].amount : 0;
+      for (j=0; j<nconsts && consts[j]!=v; j++);
+      if (j==nconsts) consts[nconsts++] = v;
+      if (superwindow[i].kind==aconst_nullCK) hasref = 1;
+  }
+  for (i=0; i<superdepth; i++) {
+      if (superinputtype[i]==SUPERREF) hasref = 1;
+  }
+  supertemplatecount = 0;
+  for (v=0; v<supernvars; v++) {
+      if (supervartype[v]==SUPERINT) {
+         superTemplate(iloadCK,v,0);
+         superTemplate(istoreCK,v,0);
+         for (j=0; j<nconsts; j++) {
+             if (consts[j]!=0 && consts[j]>=-128 && consts[j]<=127) {
+                superTemplate(iincCK,v,consts[j]);
+             }
+         }
+      } else {
+         superTemplate(aloadCK,v,0);
+         superTemplate(astoreCK,v,0);
+         hasref = 1;
+      }
+  }
+  for (j=0; j<nconsts; j++) superTemplate(ldc_intCK,consts[j],0);
+  if (hasref) superTemplate(aconst_nullCK,0,0);
+  superTemplate(iaddCK,0,0);
+  superTemplate(isubCK,0,0);
+  superTemplate(imulCK,0,0);
+  superTemplate(inegCK,0,0);
+  superTemplate(i2cCK,0,0);
+  superTemplate(dupCK,0,0);
+  superTemplate(popCK,0,0);
+  superTemplate(swapCK,0,0);
+}
+
+void superTry(int length)
+{ STATE s;
+  int i;
+  if (!superRun(supercand,length,&s,0,0) || !superSame(&s,&superfinal,0)) return;
+  supercharcount = 0;
+  superRun(superwindow,superwindowlength,&superfinalsym,0,1);
+  if (!superRun(supercand,length,&s,0,1) || !superSame(&s,&superfinalsym,1)) return;
+  for (i=0; i<length; i++) superbest[i] = supercand[i];
+  superbestlength = length;
+  superbestbytes = superCost(supercand,length,superlocals);
+  superfound = 1;
+}
+
+/* enumerates the replacements that are cheaper than the best one so far */
+void superEnumerate(int length, int maxlength, int height, int bytes)
+{ int t, k, b;
+  if (bytes<superbestbytes || (bytes==superbestbytes && length<superbestlength)) {
+     superTry(length);
+  }
+  if (length==maxlength) return;
+  for (t=0; t<supertemplatecount; t++) {
+      k = superKind(supertemplates[t].kind);
+      b = bytes+superBytes(&supertemplates[t],superlocals);
+      if (b>superbestbytes || (b==superbestbytes && length+1>=superbestlength)) continue;
+      if (height-codeinfo[k].pops< -superdepth) continue;
+      if (height-codeinfo[k].pops+codeinfo[k].pushes>SUPERSTACK-superdepth) continue;
+      supercand[length] = supertemplates[t];
+      superEnumerate(length+1,maxlength,
+                     height-codeinfo[k].pops+codeinfo[k].pushes,b);
+  }
+}
+
+/* searches for the cheapest sequence equivalent to the current window */
+int superSearch()
+{ if (!superAnalyse()) return 0;
+  superTemplates();
+  superbestbytes = superCost(superwindow,superwindowlength,superlocals);
+  superbestlength = superwindowlength;
+  superfound = 0;
+  superEnumerate(0,superwindowlength<SUPERMAX ? superwindowlength : SUPERMAX-1,0,0);
+  return superfound;
+}
+
+/****************  the rule database  ****************/
+
+RULE *superrules[CODEKINDS];
+int superrulecount;
+
+void superAddRule(RULE *r)
+{ r->next = superrules[r->from[0].kind];
+  superrules[r->from[0].kind] = r;
+  superrulecount++;
+}
+
+/* parses one side of a rule; returns the number of instructions or -1 */
+int superParse(char *text, SUPERINSN *s)
+{ char name[64], arg[64], *p, *end;
+  int n, k, fields, amount;
+  n = 0;
+  for (p=text; *p!='\0'; p=end) {
+      end = strchr(p,';');
+      if (end==NULL) end = p+strlen(p);
+      arg[0] = '\0';
+      amount = 0;
+      fields = sscanf(p,"%63s %63s %i",name,arg,&amount);
+      if (*end==';') end++;
+      if (fields<1 || name[0]==';') continue;
+      if (n==SUPERMAX) return -1;
+      for (k=0; k<CODEKINDS && (superKind(k)==-1 || strcmp(codeinfo[k].name,name)!=0); k++);
+      if (k==CODEKINDS) return -1;
+      s[n].kind = k;
+      s[n].arg = s[n].amount = 0;
+      switch (codeinfo[k].operand) {
+        case CILOCAL:
+        case CIIINC:
+             if (sscanf(arg,"v%i",&s[n].arg)!=1 || s[n].arg<0 ||
+                 s[n].arg>=SUPERVARS) return -1;
+             s[n].amount = amount;
+             break;
+        case CIINT:
+             if (sscanf(arg,"%i",&s[n].arg)!=1) return -1;
+             break;
+      }
+      n++;
+  }
+  return n;
+}
+
+/* loads the rules in file; a missing file is an empty database */
+int superLoad(char *file)
+{ FILE *f;
+  char line[1024], *arrow;
+  RULE *r;
+  f = fopen(file,"r");
+  if (f==NULL) return 0;
+  while (fgets(line,sizeof(line),f)!=NULL) {
+    if (line[0]=='#') continue;
+    arrow = strstr(line,"=>");
+    if (arrow==NULL) continue;
+    cacheMix(line);
+    *arrow = '\0';
+    r = NEW(RULE);
+    r->n = superParse(line,r->from);
+    r->m = superParse(arrow+2,r->to);
+    if (r->n<=0 || r->m<0) {
+       reportStrGlobalError("Bad rule in %s",file);
+       continue;
+    }
+    superAddRule(r);
+  }
+  fclose(f);
+  return 1;
+}
+
+int superMatch(RULE *r, CODE *c, int *locals)
+{ SUPERINSN s;
+  int i, nvars;
+  nvars = 0;
+  for (i=0; i<r->n; i++, c=c->next) {
+      if (c==NULL || c->kind!=r->from[i].kind) return 0;
+      if (!superFromCODE(c,&s,locals,&nvars)) return 0;
+      if (s.arg!=r->from[i].arg || s.amount!=r->from[i].amount) return 0;
+  }
+  return 1;
+}
+
+/* superopt_rules: the rules of the database as a peephole pattern.  The
+ * locals are numbered as they are first seen, exactly as when the rule was
+ * found, so distinct variables always match distinct locals.
+ */
+int superopt_rules(CODE **c)
+{ RULE *r;
+  CODE *code;
+  int locals[SUPERVARS], i, from, to;
+  if (*c==NULL) return 0;
+  for (r=superrules[(*c)->kind]; r!=NULL; r=r->next) {
+      if (!superMatch(r,*c,locals)) continue;
+      from = superCost(r->from,r->n,locals);
+      to = superCost(r->to,r->m,locals);
+      if (to>from || (to==from && r->m>=r->n)) continue;
+      code = NULL;
+      for (i=r->m-1; i>=0; i--) code = superToCODE(&r->to[i],locals,code);
+      return replace(c,r->n,code);
+  }
+  return 0;
+}
+
+/****************  collecting windows  ****************/
+
+typedef struct SEEN {
+  char *text;
+  struct SEEN *next;
+} SEEN;
+
+SEEN *superseen;
+int superwindows, supernew;
+FILE *superfile;
+
+int superSeen(char *text)
+{ SEEN *s;
+  for (s=superseen; s!=NULL; s=s->next) {
+      if (strcmp(s->text,text)==0) return 1;
+  }
+  s = NEW(SEEN);
+  s->text = text;
+  s->next = superseen;
+  superseen = s;
+  return 0;
+}
+
+/* does some rule already apply within the n instructions at c? */
+int superCovered(CODE *c, int n)
+{ RULE *r;
+  int locals[SUPERVARS], i;
+  for (i=0; i<n; i++, c=c->next) {
+      for (r=superrules[c->kind]; r!=NULL; r=r->next) {
+          if (r->n<=n-i && superMatch(r,c,locals)) return 1;
+      }
+  }
+  return 0;
+}
+
+/* searches the windows of exactly n instructions in c */
+void superCODE(CODE *c, int n)
+{ CODE *p;
+  RULE *r;
+  int i;
+  for (; c!=NULL; c=c->next) {
+      supernvars = 0;
+      for (i=0, p=c; i<n && p!=NULL; i++, p=p->next) {
+          if (!superFromCODE(p,&superwindow[i],superlocals,&supernvars)) break;
+      }
+      if (i<n || superCovered(c,n)) continue;
+      superwindowlength = n;
+      if (superSeen(superText(superwindow,n))) continue;
+      superwindows++;
+      if (!superSearch()) continue;
+      r = NEW(RULE);
+      r->n = superwindowlength;
+      r->m = superbestlength;
+      for (i=0; i<r->n; i++) r->from[i] = superwindow[i];
+      for (i=0; i<r->m; i++) r->to[i] = superbest[i];
+      superAddRule(r);
+      supernew++;
+      fprintf(superfile,"%s => %s\n",superText(r->from,r->n),superText(r->to,r->m));
+      printf("  %s => %s\n",superText(r->from,r->n),superText(r->to,r->m));
+  }
+}
+
+void superCLASSFILE(CLASSFILE *c, int n)
+{ CONSTRUCTOR *k;
+  METHOD *m;
+  if (c!=NULL) {
+     superCLASSFILE(c->next,n);
+     if (c->class->external) return;
+     for (k=c->class->constructors; k!=NULL; k=k->next) superCODE(k->opcodes,n);
+     for (m=c->class->methods; m!=NULL; m=m->next) superCODE(m->opcodes,n);
+  }
+}
+
+/* Searches every window of the program and appends the new rules to file.
+ * Short windows go first, and a window is skipped once a rule applies
+ * anywhere inside it, so the database holds no rule that a shorter one
+ * already subsumes.
+ */
+void superPROGRAM(PROGRAM *p, char *file)
+{ PROGRAM *q;
+  int n;
+  superfile = fopen(file,"a");
+  if (superfile==NULL) {
+     reportStrGlobalError("Unable to open rule database %s",file);
+     return;
+  }
+  superSeed();
+  superseen = NULL;
+  superwindows = supernew = 0;
+  printf("\nSuperoptimizer rules found:\n");
+  for (n=2; n<=SUPERMAX; n++) {
+      for (q=p; q!=NULL; q=q->next) superCLASSFILE(q->classfile,n);
+  }
+  printf("%i windows searched, %i new rules\n",superwindows,supernew);
+  fclose(superfile);
+}
@@ -0,0 +1,45 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* A bounded superoptimizer.  With -S, every straight-line window of up to
+ * SUPERMAX instructions in the optimized program is compared against all
+ * cheaper sequences over the same locals and constants; the ones proven
+ * equivalent are appended to the rule database named with -R.  With -O and
+ * -R the rules are loaded and applied as one more peephole pattern.
+ *
+ * A rule is one line of the form
+ *   iload v0 ; ldc_int 1 ; iadd ; istore v0 => iinc v0 1
+ * where v0, v1, ... stand for distinct locals.
+ */
+
+#define SUPERMAX 4
+#define SUPERVARS SUPERMAX
+
+typedef struct SUPERINSN {
+  int kind;
+  int arg;      /* variable of a load, store or iinc, constant of ldc_int */
+  int amount;   /* of an iinc */
+} SUPERINSN;
+
+typedef struct RULE {
+  int n, m;
+  SUPERINSN from[SUPERMAX], to[SUPERMAX];
+  struct RULE *next;
+} RULE;
+
+extern int superrulecount;
+
+int superLoad(char *file);
+int superopt_rules(CODE **c);
+void superPROGRAM(PROGRAM *p, char *file);
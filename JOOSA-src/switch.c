@@ -0,0 +1,221 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include "memory.h"
+#include "flow.h"
+#include "codeinfo.h"
+#include "optimize.h"
+#include "switch.h"
+
+/* Shorter chains are about as fast as a switch and smaller.  A
+ * lookupswitch takes 8 bytes a case against about 5 for a test, so it
+ * needs a longer chain before its binary search pays for that.
+ */
+#define SWITCHMIN 4
+#define LOOKUPMIN 8
+
+int switchchains;
+
+/* If a test of a local against a constant starts at i, returns the index
+ * of its branch and sets the local, the constant and the instructions that
+ * follow when they are equal and when they are not; otherwise returns -1.
+ */
+int switchTest(FLOW *f, int i, int *x, int *key, int *match, int *miss)
+{ int b;
+  if (i+1>=f->count || f->code[i]->kind!=iloadCK) return -1;
+  *x = f->code[i]->val.iloadC;
+  *key = 0;
+  b = i+1;
+  if (f->code[b]->kind==ldc_intCK) {
+     *key = f->code[b]->val.ldc_intC;
+     b++;
+     if (b>=f->count) return -1;
+  }
+  if (f->target[b]==-1 || b+1>=f->count) return -1;
+  if (f->code[b]->kind==(b==i+1 ? ifeqCK : if_icmpeqCK)) {
+     *match = f->target[b];
+     *miss = b+1;
+     return b;
+  }
+  if (f->code[b]->kind==(b==i+1 ? ifneCK : if_icmpneCK)) {
+     *match = b+1;
+     *miss = f->target[b];
+     return b;
+  }
+  return -1;
+}
+
+int switchSkip(FLOW *f, int i)
+{ while (i<f->count && f->code[i]->kind==labelCK) i++;
+  return i;
+}
+
+/* 1 if the only way to the instruction at t is from the branch at b, which
+ * takes it or falls through to it; into counts the branches to every label
+ */
+int switchOnly(FLOW *f, int b, int t, int *into)
+{ int j;
+  for (j=t-1; j>b && f->code[j]->kind==labelCK; j--) {
+      if (into[j]>(f->target[b]==j ? 1 : 0)) return 0;
+  }
+  return j==b || !flowFallsThrough(f->code[j]);
+}
+
+/* a label for code[i], which is inserted in front of it unless code[i] is
+ * a label already; labelat remembers the ones inserted
+ */
+int switchLabel(FLOW *f, int i, int *labelat)
+{ CODE *p;
+  if (f->code[i]->kind==labelCK) return copylabel(f->code[i]->val.labelC);
+  if (labelat[i]!=-1) return copylabel(labelat[i]);
+  labelat[i] = next_label();
+  for (p=f->code[i-1]; p->next!=f->code[i]; p=p->next);
+  p->next = makeCODElabel(labelat[i],f->code[i]);
+  INSERTnewlabel(labelat[i],"case",p->next,1);
+  return labelat[i];
+}
+
+/* Lowers the chain that starts with the test at i, if it is long enough.
+ * The chain only goes on to tests that nothing else reaches, so that they
+ * all become unreachable.
+ */
+int switchChain(FLOW *f, int i, int *into, char *done, int *labelat)
+{ int *keys, *matches, *labels;
+  int n, t, b, b0, x, x0, key, match, miss, fallback, j, k, lo, hi, table;
+  SWITCH *s;
+  keys = Malloc((f->count+1)*sizeof(int));
+  matches = Malloc((f->count+1)*sizeof(int));
+  n = 0;
+  x0 = -1;
+  b0 = -1;
+  fallback = -1;
+  for (t=i; t<f->count && !done[t]; t=switchSkip(f,miss)) {
+      b = switchTest(f,t,&x,&key,&match,&miss);
+      if (b==-1 || (n>0 && x!=x0)) break;
+      if (n==0) {
+         x0 = x;
+         b0 = b;
+      }
+      done[t] = 1;
+      fallback = miss;
+      /* sorted by key; a later test of the same key is never true */
+      for (j=n; j>0 && keys[j-1]>key; j--);
+      if (j==0 || keys[j-1]!=key) {
+         for (k=n; k>j; k--) {
+             keys[k] = keys[k-1];
+             matches[k] = matches[k-1];
+         }
+         keys[j] = key;
+         matches[j] = match;
+         n++;
+      }
+      if (switchSkip(f,miss)<=t || !switchOnly(f,b,switchSkip(f,miss),into)) break;
+  }
+  if (n<SWITCHMIN) return 0;
+
+  /* the space and time estimates javac uses to pick one */
+  lo = keys[0];
+  hi = keys[n-1];
+  table = 4.0+((double)hi-lo+1)+3*3 <= 3.0+2*n+3*n;
+  if (!table && n<LOOKUPMIN) return 0;
+  s = NEW(SWITCH);
+  s->defaultlabel = switchLabel(f,fallback,labelat);
+  if (table) {
+     s->count = hi-lo+1;
+     s->keys = Malloc((s->count+1)*sizeof(int));
+     labels = Malloc((s->count+1)*sizeof(int));
+     for (k=0, j=0; k<s->count; k++) {
+         s->keys[k] = lo+k;
+         if (keys[j]==lo+k) {
+            labels[k] = switchLabel(f,matches[j++],labelat);
+         } else {
+            labels[k] = copylabel(s->defaultlabel);
+         }
+     }
+  } else {
+     s->count = n;
+     s->keys = keys;
+     labels = Malloc((n+1)*sizeof(int));
+     for (k=0; k<n; k++) labels[k] = switchLabel(f,matches[k],labelat);
+  }
+  s->labels = labels;
+
+  /* the branch becomes the switch, so labels inserted after it stay put */
+  droplabel(codeinfoInt(f->code[b0]));
+  f->code[b0]->kind = table ? tableswitchCK : lookupswitchCK;
+  if (table) f->code[b0]->val.tableswitchC = s;
+  else f->code[b0]->val.lookupswitchC = s;
+  f->code[i]->next = f->code[b0];
+  return 1;
+}
+
+void switchDrop(CODE *c)
+{ SWITCH *s;
+  int l, k;
+  if (uses_label(c,&l)) droplabel(l);
+  s = codeinfoSwitch(c);
+  if (s==NULL) return;
+  for (k=0; k<s->count; k++) droplabel(s->labels[k]);
+  droplabel(s->defaultlabel);
+}
+
+/* removes the instructions that neither a label nor the one before leads
+ * to, mostly tests that a switch has replaced
+ */
+void switchUnreachable(CODE **c)
+{ CODE **p;
+  int live, change;
+  do {
+    change = 0;
+    live = 1;
+    for (p=c; *p!=NULL;) {
+        if ((*p)->kind==labelCK && !deadlabel((*p)->val.labelC)) live = 1;
+        if (live) {
+           live = flowFallsThrough(*p);
+           p = &(*p)->next;
+        } else {
+           switchDrop(*p);
+           *p = (*p)->next;
+           change = 1;
+        }
+    }
+  } while (change);
+}
+
+int switchCODE(CODE **c)
+{ FLOW *f;
+  char *done;
+  int *into, *labelat;
+  int i, change;
+  f = flowCODE(*c,0);
+  done = Malloc(f->count+1);
+  into = Malloc((f->count+1)*sizeof(int));
+  labelat = Malloc((f->count+1)*sizeof(int));
+  for (i=0; i<f->count; i++) {
+      done[i] = 0;
+      into[i] = 0;
+      labelat[i] = -1;
+  }
+  for (i=0; i<f->count; i++) {
+      if (f->target[i]!=-1) into[f->target[i]]++;
+  }
+  change = 0;
+  for (i=0; i<f->count; i++) {
+      if (f->height[i]!=-1 && switchChain(f,i,into,done,labelat)) {
+         switchchains++;
+         change = 1;
+      }
+  }
+  if (change) switchUnreachable(c);
+  return change;
+}
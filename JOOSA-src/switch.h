@@ -0,0 +1,23 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Switch lowering: a chain of tests of one int local against constants,
+ * where each failed test goes straight to the next, becomes a tableswitch
+ * or a lookupswitch.  It runs after every pass that builds a FLOW, since a
+ * FLOW has room for one branch target per instruction only.
+ */
+
+extern int switchchains;
+
+int switchCODE(CODE **c);
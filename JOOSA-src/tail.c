@@ -0,0 +1,125 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <string.h>
+#include "memory.h"
+#include "flow.h"
+#include "cha.h"
+#include "codeinfo.h"
+#include "optimize.h"
+#include "tail.h"
+
+int tailcalls;
+
+/* 1 if the invoke c always reaches m of class */
+int tailSelf(CODE *c, CLASS *class, METHOD *m)
+{ CLASS *target;
+  IMPLEMENTATION *targets;
+  char *invoke, *name;
+  if (c->kind==invokenonvirtualCK) invoke = c->val.invokenonvirtualC;
+  else if (c->kind==invokevirtualCK) invoke = c->val.invokevirtualC;
+  else return 0;
+  if (!chaSplit(invoke,&target,&name) || strcmp(name,m->name)!=0) return 0;
+  if (strcmp(strchr(invoke,'('),m->signature)!=0) return 0;
+  if (c->kind==invokenonvirtualCK) return target==class;
+  /* a virtual call on this can only go elsewhere through an override */
+  return chaTargets(class,name,&targets)==1 && targets->method==m;
+}
+
+/* 1 if control flows from instruction i straight to a return */
+int tailReturns(FLOW *f, int i)
+{ int steps;
+  for (steps=0; i<f->count && steps<f->count; steps++) {
+      switch (f->code[i]->kind) {
+        case labelCK:
+        case nopCK:
+             i++;
+             break;
+        case gotoCK:
+             i = f->target[i];
+             break;
+        case ireturnCK:
+        case areturnCK:
+        case returnCK:
+             return 1;
+        default:
+             return 0;
+      }
+  }
+  return 0;
+}
+
+/* The index of the "aload_0" that pushes the receiver of the call at i,
+ * or -1.  No instruction in between may pop that slot, as getfield does in
+ * "aload_0 getfield Node/next", and nothing outside them may branch into
+ * them, so removing that load leaves every path to the call with its
+ * arguments.
+ */
+int tailReceiver(FLOW *f, int i)
+{ int j, k;
+  for (j=i-1; j>=0 && f->height[j]>0; j--);
+  if (j<0 || f->height[j]!=0) return -1;
+  if (f->code[j]->kind!=aloadCK || f->code[j]->val.aloadC!=0) return -1;
+  for (k=j+1; k<i; k++) {
+      if (f->height[k]>=0 && f->height[k]-codeinfoPops(f->code[k])<1) return -1;
+  }
+  for (k=0; k<f->count; k++) {
+      if ((k<j || k>i) && f->target[k]>j && f->target[k]<=i) return -1;
+  }
+  return j;
+}
+
+int tailCODE(CODE **c, CLASS *class, METHOD *m)
+{ FLOW *f;
+  FORMAL *formal;
+  TYPE **types;
+  CODE *r;
+  int i, j, k, count, label;
+  if (m->modifier==staticMod) return 0;
+  f = flowCODE(*c,m->localslimit);
+  for (i=0; i<f->count; i++) {
+      /* this is only ever in local 0 if nothing stores there */
+      if (f->code[i]->kind==astoreCK && f->code[i]->val.astoreC==0) return 0;
+  }
+  count = 0;
+  for (formal=m->formals; formal!=NULL; formal=formal->next) count++;
+  types = Malloc((count+1)*sizeof(TYPE *));
+  for (formal=m->formals; formal!=NULL; formal=formal->next) {
+      types[formal->offset] = formal->type;
+  }
+
+  label = -1;
+  for (i=0; i<f->count; i++) {
+      if (f->height[i]!=count+1 || !tailSelf(f->code[i],class,m)) continue;
+      if (!tailReturns(f,i+1)) continue;
+      j = tailReceiver(f,i);
+      if (j==-1) continue;
+      if (label==-1) {
+         label = next_label();
+         *c = makeCODElabel(label,*c);
+         INSERTnewlabel(label,"tail",*c,0);
+      }
+      /* the last argument is on top */
+      r = makeCODEgoto(copylabel(label),f->code[i]->next);
+      for (k=1; k<=count; k++) {
+          if (types[k]->kind==refK || types[k]->kind==polynullK) {
+             r = makeCODEastore(k,r);
+          } else {
+             r = makeCODEistore(k,r);
+          }
+      }
+      *f->code[i] = *r;
+      f->code[j]->kind = nopCK;
+      tailcalls++;
+  }
+  return label!=-1;
+}
@@ -0,0 +1,22 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include "tree.h"
+
+/* Tail-recursion elimination: a call of the current method on this whose
+ * result is returned at once becomes stores to the formals and a jump back
+ * to the start of the method.
+ */
+
+extern int tailcalls;
+
+int tailCODE(CODE **c, CLASS *class, METHOD *m);
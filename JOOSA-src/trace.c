@@ -0,0 +1,100 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "memory.h"
+#include "error.h"
+#include "codeinfo.h"
+#include "trace.h"
+
+FILE *tracefile;
+int tracemethods;
+
+void traceNumber(unsigned long n)
+{ while (n>=0x80) {
+    putc((int)(n&0x7f)|0x80,tracefile);
+    n >>= 7;
+  }
+  putc((int)n,tracefile);
+}
+
+void traceName(char *name)
+{ traceNumber(strlen(name));
+  fwrite(name,1,strlen(name),tracefile);
+}
+
+void traceOpen(char *file)
+{ tracefile = fopen(file,"wb");
+  if (tracefile==NULL) {
+     reportStrGlobalError("Unable to open trace file %s",file);
+     return;
+  }
+  fwrite(TRACEMAGIC,1,strlen(TRACEMAGIC),tracefile);
+  tracemethods = 0;
+}
+
+void tracePattern(int index, char *name)
+{ if (tracefile==NULL) return;
+  putc(TRACEPATTERN,tracefile);
+  traceNumber(index);
+  traceName(name);
+}
+
+void traceSize(CODE *c, int *count, int *bytes)
+{ *count = *bytes = 0;
+  for (; c!=NULL; c=c->next) {
+      (*count)++;
+      *bytes += codeinfoSize(c);
+  }
+}
+
+/* starts the trace of a method, which gets the next id */
+void traceMethod(char *class, char *name, CODE *c)
+{ char *s;
+  int count, bytes;
+  if (tracefile==NULL) return;
+  s = Malloc(strlen(class)+strlen(name)+2);
+  sprintf(s,"%s.%s",class,name);
+  traceSize(c,&count,&bytes);
+  putc(TRACEMETHOD,tracefile);
+  traceNumber(tracemethods++);
+  traceName(s);
+  traceNumber(count);
+  traceNumber(bytes);
+}
+
+/* records that pattern succeeded at the instruction at of method, or that
+ * the global pass pattern changed method when at is NULL
+ */
+void traceRewrite(int sweep, CODE *method, CODE *at, int pattern)
+{ CODE *c;
+  int position, count, bytes;
+  position = 0;
+  if (at!=NULL) {
+     for (c=method; c!=NULL && c!=at; c=c->next) position++;
+  }
+  traceSize(method,&count,&bytes);
+  putc(TRACEREWRITE,tracefile);
+  traceNumber(tracemethods-1);
+  traceNumber(sweep);
+  traceNumber(position);
+  traceNumber(pattern);
+  traceNumber(count);
+  traceNumber(bytes);
+}
+
+void traceClose()
+{ if (tracefile==NULL) return;
+  fclose(tracefile);
+  tracefile = NULL;
+}
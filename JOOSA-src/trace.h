@@ -0,0 +1,44 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+#include <stdio.h>
+#include "tree.h"
+
+/* The rewrite trace written with -T and read by tracedump.  The file starts
+ * with TRACEMAGIC followed by records, each a tag byte and numbers in
+ * unsigned LEB128.
+ *
+ *   TRACEPATTERN  index, name
+ *   TRACEMETHOD   id, name, instructions, bytes
+ *   TRACEREWRITE  method, sweep, position, pattern,
+ *                 instructions after, bytes after
+ *
+ * A name is its length and characters.  The global passes are numbered
+ * after the patterns, and a run of one that changed the method is a
+ * rewrite at position 0.  Every change to the method is recorded, so its
+ * size before a rewrite is its size after the previous record for it.
+ * Nothing is done unless tracefile is set, and it is tested only after a
+ * pattern or pass has succeeded.
+ */
+
+#define TRACEMAGIC "JOOSTRC1"
+#define TRACEPATTERN 1
+#define TRACEMETHOD 2
+#define TRACEREWRITE 3
+
+extern FILE *tracefile;
+
+void traceOpen(char *file);
+void tracePattern(int index, char *name);
+void traceMethod(char *class, char *name, CODE *c);
+void traceRewrite(int sweep, CODE *method, CODE *at, int pattern);
+void traceClose();
@@ -0,0 +1,324 @@
+/*
+ * JOOS is Copyright (C) 1997 Laurie Hendren & Michael I. Schwartzbach
+ *
+ * Reproduction of all or part of this software is permitted for
+ * educational or research use on condition that this copyright notice is
+ * included in any copy. This software comes with no warranty of any
+ * kind. In no event will the authors be liable for any damages resulting from
+ * use of this software.
+ *
+ * email: hendren@cs.mcgill.ca, mis@brics.dk
+ */
+
+/* tracedump: summarizes a rewrite trace written by joos -O -T file.
+ *
+ * usage:  tracedump [-n count] [-m method] file
+ *
+ * Without -m it lists the methods, patterns and positions with the most
+ * rewrites, and the pairs of patterns that undo each other.  With -m it
+ * prints the rewrites of one method in order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+typedef struct METHODINFO {
+  char *name;
+  int count, bytes;          /* before optimization */
+  int lastcount, lastbytes;  /* after the last rewrite */
+  int rewrites, sweeps;
+} METHODINFO;
+
+typedef struct REWRITE {
+  int method, sweep, position, pattern;
+  int before, after;          /* instructions */
+  int beforebytes, afterbytes;
+} REWRITE;
+
+typedef struct GROUP {
+  int a, b, count;
+  long saved;
+} GROUP;
+
+char **patterns;
+int patterncount;
+METHODINFO *methods;
+int methodcount;
+REWRITE *rewrites;
+int rewritecount;
+
+FILE *in;
+
+void *grow(void *p, int count, int size)
+{ if ((count&(count-1))!=0 && count!=0) return p;
+  p = realloc(p,(count==0 ? 1 : 2*count)*size);
+  if (p==NULL) {
+     fprintf(stderr,"tracedump: out of memory\n");
+     exit(1);
+  }
+  return p;
+}
+
+unsigned long readNumber()
+{ unsigned long n;
+  int c, shift;
+  n = 0;
+  shift = 0;
+  do {
+    c = getc(in);
+    if (c==EOF) {
+       fprintf(stderr,"tracedump: truncated trace\n");
+       exit(1);
+    }
+    n |= (unsigned long)(c&0x7f)<<shift;
+    shift += 7;
+  } while (c&0x80);
+  return n;
+}
+
+char *readName()
+{ char *s;
+  int length;
+  length = readNumber();
+  s = malloc(length+1);
+  if (s==NULL || fread(s,1,length,in)!=length) {
+     fprintf(stderr,"tracedump: truncated trace\n");
+     exit(1);
+  }
+  s[length] = '\0';
+  return s;
+}
+
+char *patternName(int i)
+{ return i<patterncount && patterns[i]!=NULL ? patterns[i] : "?";
+}
+
+void readTrace(char *file)
+{ char magic[sizeof(TRACEMAGIC)];
+  int tag, i;
+  METHODINFO *m;
+  REWRITE *r;
+  in = fopen(file,"rb");
+  if (in==NULL) {
+     fprintf(stderr,"tracedump: cannot open %s\n",file);
+     exit(1);
+  }
+  if (fread(magic,1,strlen(TRACEMAGIC),in)!=strlen(TRACEMAGIC) ||
+      strncmp(magic,TRACEMAGIC,strlen(TRACEMAGIC))!=0) {
+     fprintf(stderr,"tracedump: %s is not a rewrite trace\n",file);
+     exit(1);
+  }
+  while ((tag = getc(in))!=EOF) {
+    switch (tag) {
+      case TRACEPATTERN:
+           i = readNumber();
+           while (patterncount<=i) {
+             patterns = grow(patterns,patterncount,sizeof(char *));
+             patterns[patterncount++] = NULL;
+           }
+           patterns[i] = readName();
+           break;
+      case TRACEMETHOD:
+           readNumber();
+           methods = grow(methods,methodcount,sizeof(METHODINFO));
+           m = &methods[methodcount++];
+           m->name = readName();
+           m->count = m->lastcount = readNumber();
+           m->bytes = m->lastbytes = readNumber();
+           m->rewrites = m->sweeps = 0;
+           break;
+      case TRACEREWRITE:
+           rewrites = grow(rewrites,rewritecount,sizeof(REWRITE));
+           r = &rewrites[rewritecount++];
+           r->method = readNumber();
+           r->sweep = readNumber();
+           r->position = readNumber();
+           r->pattern = readNumber();
+           r->after = readNumber();
+           r->afterbytes = readNumber();
+           if (r->method>=methodcount) {
+              fprintf(stderr,"tracedump: rewrite of unknown method %i\n",r->method);
+              exit(1);
+           }
+           m = &methods[r->method];
+           r->before = m->lastcount;
+           r->beforebytes = m->lastbytes;
+           m->lastcount = r->after;
+           m->lastbytes = r->afterbytes;
+           m->rewrites++;
+           if (r->sweep>m->sweeps) m->sweeps = r->sweep;
+           break;
+      default:
+           fprintf(stderr,"tracedump: bad record %i\n",tag);
+           exit(1);
+    }
+  }
+  fclose(in);
+}
+
+int byRewrites(const void *a, const void *b)
+{ return ((METHODINFO *)b)->rewrites-((METHODINFO *)a)->rewrites;
+}
+
+int byCount(const void *a, const void *b)
+{ return ((GROUP *)b)->count-((GROUP *)a)->count;
+}
+
+int bySite(const void *a, const void *b)
+{ REWRITE *x, *y;
+  x = (REWRITE *)a;
+  y = (REWRITE *)b;
+  if (x->method!=y->method) return x->method-y->method;
+  return x->position-y->position;
+}
+
+void hotMethods(int n)
+{ METHODINFO *sorted;
+  int i;
+  sorted = malloc((methodcount+1)*sizeof(METHODINFO));
+  memcpy(sorted,methods,methodcount*sizeof(METHODINFO));
+  qsort(sorted,methodcount,sizeof(METHODINFO),byRewrites);
+  printf("\nMethods with the most rewrites:\n");
+  printf("%8s %7s  %-15s %-15s %s\n","rewrites","sweeps","instructions","bytes","method");
+  for (i=0; i<n && i<methodcount && sorted[i].rewrites>0; i++) {
+      printf("%8i %7i  %6i -> %-6i %6i -> %-6i %s\n",
+             sorted[i].rewrites,sorted[i].sweeps,
+             sorted[i].count,sorted[i].lastcount,
+             sorted[i].bytes,sorted[i].lastbytes,sorted[i].name);
+  }
+}
+
+void hotPatterns(int n)
+{ GROUP *g;
+  int i;
+  g = malloc((patterncount+1)*sizeof(GROUP));
+  for (i=0; i<patterncount; i++) {
+      g[i].a = i;
+      g[i].count = 0;
+      g[i].saved = 0;
+  }
+  for (i=0; i<rewritecount; i++) {
+      if (rewrites[i].pattern>=patterncount) continue;
+      g[rewrites[i].pattern].count++;
+      g[rewrites[i].pattern].saved += rewrites[i].beforebytes-rewrites[i].afterbytes;
+  }
+  qsort(g,patterncount,sizeof(GROUP),byCount);
+  printf("\nPatterns with the most rewrites:\n");
+  printf("%8s %8s  %s\n","rewrites","bytes","pattern");
+  for (i=0; i<n && i<patterncount && g[i].count>0; i++) {
+      printf("%8i %8li  %s\n",g[i].count,g[i].saved,patternName(g[i].a));
+  }
+}
+
+void hotSites(int n)
+{ REWRITE *sorted;
+  GROUP *g;
+  int i, j, count;
+  sorted = malloc((rewritecount+1)*sizeof(REWRITE));
+  memcpy(sorted,rewrites,rewritecount*sizeof(REWRITE));
+  qsort(sorted,rewritecount,sizeof(REWRITE),bySite);
+  g = malloc((rewritecount+1)*sizeof(GROUP));
+  count = 0;
+  for (i=0; i<rewritecount; i=j) {
+      for (j=i; j<rewritecount && bySite(&sorted[i],&sorted[j])==0; j++);
+      g[count].a = sorted[i].method;
+      g[count].b = sorted[i].position;
+      g[count].count = j-i;
+      count++;
+  }
+  qsort(g,count,sizeof(GROUP),byCount);
+  printf("\nPositions with the most rewrites:\n");
+  printf("%8s %8s  %s\n","rewrites","position","method");
+  for (i=0; i<n && i<count; i++) {
+      printf("%8i %8i  %s\n",g[i].count,g[i].b,methods[g[i].a].name);
+  }
+}
+
+/* a rewrite that restores the size the method had before the previous
+ * rewrite at the same position most likely undoes it
+ */
+void oscillations(int n)
+{ GROUP *g;
+  REWRITE *r, *p;
+  int i, j, count;
+  g = malloc((rewritecount+1)*sizeof(GROUP));
+  count = 0;
+  for (i=1; i<rewritecount; i++) {
+      r = &rewrites[i];
+      p = &rewrites[i-1];
+      if (p->method!=r->method || p->position!=r->position) continue;
+      if (r->after!=p->before || r->afterbytes!=p->beforebytes) continue;
+      if (p->before==p->after && p->beforebytes==p->afterbytes &&
+          p->pattern==r->pattern) continue;
+      for (j=0; j<count && (g[j].a!=p->pattern || g[j].b!=r->pattern); j++);
+      if (j==count) {
+         g[count].a = p->pattern;
+         g[count].b = r->pattern;
+         g[count].count = 0;
+         count++;
+      }
+      g[j].count++;
+  }
+  qsort(g,count,sizeof(GROUP),byCount);
+  printf("\nPattern pairs that undo each other:\n");
+  if (count==0) printf("  none\n");
+  for (i=0; i<n && i<count; i++) {
+      printf("%8i  %s / %s\n",g[i].count,patternName(g[i].a),patternName(g[i].b));
+  }
+}
+
+void timeline(char *name)
+{ int i, m;
+  for (m=0; m<methodcount && strcmp(methods[m].name,name)!=0; m++);
+  if (m==methodcount) m = atoi(name);
+  if (m<0 || m>=methodcount) {
+     fprintf(stderr,"tracedump: no method %s\n",name);
+     exit(1);
+  }
+  printf("%s: %i instructions, %i bytes\n",
+         methods[m].name,methods[m].count,methods[m].bytes);
+  printf("%6s %8s  %-15s %-15s %s\n","sweep","position","instructions","bytes","pattern");
+  for (i=0; i<rewritecount; i++) {
+      if (rewrites[i].method!=m) continue;
+      printf("%6i %8i  %6i -> %-6i %6i -> %-6i %s\n",
+             rewrites[i].sweep,rewrites[i].position,
+             rewrites[i].before,rewrites[i].after,
+             rewrites[i].beforebytes,rewrites[i].afterbytes,
+             patternName(rewrites[i].pattern));
+  }
+}
+
+int main(int argc, char **argv)
+{ char *file, *method;
+  int i, n, sweeps;
+  file = method = NULL;
+  n = 10;
+  for (i=1; i<argc; i++) {
+      if (strcmp(argv[i],"-n")==0 && i+1<argc) {
+         n = atoi(argv[++i]);
+      } else if (strcmp(argv[i],"-m")==0 && i+1<argc) {
+         method = argv[++i];
+      } else {
+         file = argv[i];
+      }
+  }
+  if (file==NULL) {
+     fprintf(stderr,"usage: tracedump [-n count] [-m method] file\n");
+     return 1;
+  }
+  readTrace(file);
+  if (method!=NULL) {
+     timeline(method);
+     return 0;
+  }
+  sweeps = 0;
+  for (i=0; i<methodcount; i++) sweeps += methods[i].sweeps;
+  printf("%i methods, %i rewrites, %i sweeps\n",methodcount,rewritecount,sweeps);
+  hotMethods(n);
+  hotPatterns(n);
+  hotSites(n);
+  oscillations(n);
+  return 0;
+}
@@ -61,6 +61,7 @@ FIELD *makeFIELD(char *name, TYPE *type, FIELD *next)
   f->lineno = lineno;
   f->name = name;
   f->type = type;
+  f->read = 0;
   f->next = next;
   return f;
 }
@@ -142,6 +143,7 @@ CONSTRUCTOR *makeCONSTRUCTOR(char *name, FORMAL *formals, STATEMENT *statements,
   c->name = name;
   c->formals = formals;
   c->statements = statements;
+  c->reachable = 0;
   c->next = next;
   return c;
 }
@@ -156,6 +158,10 @@ METHOD *makeMETHOD(char *name, ModifierKind modifier, TYPE *returntype,
   m->returntype = returntype;
   m->formals = formals;
   m->statements = statements;
+  m->inlinecandidate = 0;
+  m->summary = 0;
+  m->constant = NULL;
+  m->reachable = 0;
   m->next = next;
   return m;
 }
@@ -757,6 +763,46 @@ CODE *makeCODEifne(int label, CODE *next)
   return c;
 }
  
+CODE *makeCODEiflt(int label, CODE *next)
+{ CODE *c;
+  c = NEW(CODE);
+  c->kind = ifltCK;
+  c->visited = 0;
+  c->val.ifltC = label;
+  c->next = next;
+  return c;
+}
+ 
+CODE *makeCODEifge(int label, CODE *next)
+{ CODE *c;
+  c = NEW(CODE);
+  c->kind = ifgeCK;
+  c->visited = 0;
+  c->val.ifgeC = label;
+  c->next = next;
+  return c;
+}
+ 
+CODE *makeCODEifgt(int label, CODE *next)
+{ CODE *c;
+  c = NEW(CODE);
+  c->kind = ifgtCK;
+  c->visited = 0;
+  c->val.ifgtC = label;
+  c->next = next;
+  return c;
+}
+ 
+CODE *makeCODEifle(int label, CODE *next)
+{ CODE *c;
+  c = NEW(CODE);
+  c->kind = ifleCK;
+  c->visited = 0;
+  c->val.ifleC = label;
+  c->next = next;
+  return c;
+}
+ 
 CODE *makeCODEif_acmpeq(int label, CODE *next)
 { CODE *c;
   c = NEW(CODE);
@@ -1019,4 +1065,23 @@ CODE *makeCODEinvokenonvirtual(char *arg, CODE *next)
   c->next = next;
   return c;
 }
- 
+
+CODE *makeCODEtableswitch(SWITCH *arg, CODE *next)
+{ CODE *c;
+  c = NEW(CODE);
+  c->kind = tableswitchCK;
+  c->visited = 0;
+  c->val.tableswitchC = arg;
+  c->next = next;
+  return c;
+}
+
+CODE *makeCODElookupswitch(SWITCH *arg, CODE *next)
+{ CODE *c;
+  c = NEW(CODE);
+  c->kind = lookupswitchCK;
+  c->visited = 0;
+  c->val.lookupswitchC = arg;
+  c->next = next;
+  return c;
+}
@@ -61,6 +61,7 @@ typedef struct FIELD {
   char *name;
   struct TYPE *type;
   int offset; /* resource */
+  int read; /* field */
   struct FIELD *next;
 } FIELD;
 
@@ -86,6 +87,7 @@ typedef struct CONSTRUCTOR {
   char *signature; /* code */
   struct LABEL *labels; /* code */
   struct CODE *opcodes; /* code */
+  int reachable; /* reach */
   struct CONSTRUCTOR *next;
 } CONSTRUCTOR;
 
@@ -101,6 +103,10 @@ typedef struct METHOD {
   char *signature; /* code */
   struct LABEL *labels; /* code */
   struct CODE *opcodes; /* code */
+  int inlinecandidate; /* cha */
+  int summary; /* summary */
+  struct CODE *constant; /* summary */
+  int reachable; /* reach */
   struct METHOD *next;
 } METHOD;
 
@@ -231,18 +237,19 @@ typedef struct LABEL {
    struct CODE *position;
 } LABEL;
 
+typedef struct SWITCH {
+   int count;
+   int *keys;          /* ascending, consecutive in a tableswitch */
+   int *labels;
+   int defaultlabel;
+} SWITCH;
+
 typedef struct CODE {
-   enum {nopCK,i2cCK,
-         newCK,instanceofCK,checkcastCK,
-         imulCK,inegCK,iremCK,isubCK,idivCK,iaddCK,iincCK,
-         labelCK,gotoCK,ifeqCK,ifneCK,if_acmpeqCK,if_acmpneCK,
-         ifnullCK,ifnonnullCK,
-         if_icmpeqCK,if_icmpgtCK,if_icmpltCK,
-         if_icmpleCK,if_icmpgeCK,if_icmpneCK,
-         ireturnCK,areturnCK,returnCK,
-         aloadCK,astoreCK,iloadCK,istoreCK,dupCK,popCK,swapCK,
-         ldc_intCK,ldc_stringCK,aconst_nullCK,
-         getfieldCK,putfieldCK,invokevirtualCK,invokenonvirtualCK} kind;
+   enum {
+#define CODEKIND(name,flags,operand,pops,pushes,size) name##CK,
+#include "codekind.h"
+#undef CODEKIND
+         lastCK} kind; /* lastCK counts the kinds, see codekind.h */
    int visited; /* emit */
    union {
      char *newC;
@@ -253,6 +260,10 @@ typedef struct CODE {
      int gotoC;
      int ifeqC;
      int ifneC;
+     int ifltC;
+     int ifgeC;
+     int ifgtC;
+     int ifleC;
      int if_acmpeqC;
      int if_acmpneC;
      int ifnullC;
@@ -273,6 +284,8 @@ typedef struct CODE {
      char *putfieldC;
      char *invokevirtualC;
      char *invokenonvirtualC;
+     struct SWITCH *tableswitchC;
+     struct SWITCH *lookupswitchC;
    } val;
    struct CODE *next;
 } CODE;
@@ -357,6 +370,10 @@ CODE *makeCODElabel(int label, CODE *next);
 CODE *makeCODEgoto(int label, CODE *next);
 CODE *makeCODEifeq(int label, CODE *next);
 CODE *makeCODEifne(int label, CODE *next);
+CODE *makeCODEiflt(int label, CODE *next);
+CODE *makeCODEifge(int label, CODE *next);
+CODE *makeCODEifgt(int label, CODE *next);
+CODE *makeCODEifle(int label, CODE *next);
 CODE *makeCODEif_acmpeq(int label, CODE *next);
 CODE *makeCODEif_acmpne(int label, CODE *next);
 CODE *makeCODEifnull(int label, CODE *next);
@@ -384,5 +401,7 @@ CODE *makeCODEgetfield(char *arg, CODE *next);
 CODE *makeCODEputfield(char *arg, CODE *next);
 CODE *makeCODEinvokevirtual(char *arg, CODE *next);
 CODE *makeCODEinvokenonvirtual(char *arg, CODE *next);
+CODE *makeCODEtableswitch(SWITCH *arg, CODE *next);
+CODE *makeCODElookupswitch(SWITCH *arg, CODE *next);
 
 #endif
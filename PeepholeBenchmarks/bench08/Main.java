@@ -0,0 +1,42 @@
+import joos.lib.*;
+
+/* Casts guarded by instanceof.  The verifier does not narrow the type of a
+ * local after instanceof, so each checkcast below must stay.
+ */
+public class Main {
+  public Main() { super(); }
+
+  public int length(Object o) {
+    if (o instanceof String) return ((String)o).length();
+    return -1;
+  }
+
+  public String describe(Object o) {
+    String s;
+    s = "other";
+    if (o instanceof Integer) {
+       s = "int " + ((Integer)o).intValue();
+    }
+    if (o instanceof String && ((String)o).length() > 2) {
+       s = "long string " + ((String)o).toUpperCase();
+    }
+    return s;
+  }
+
+  public static void main(String[] args) {
+    Main m;
+    JoosIO io;
+    Object o;
+    String line;
+    m = new Main();
+    io = new JoosIO();
+    line = io.readLine();
+    while (line != null) {
+      o = line;
+      io.println("" + m.length(o) + " " + m.describe(o));
+      o = new Integer(line.length());
+      io.println("" + m.length(o) + " " + m.describe(o));
+      line = io.readLine();
+    }
+  }
+}
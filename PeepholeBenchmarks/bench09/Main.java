@@ -0,0 +1,30 @@
+import joos.lib.*;
+
+/* Calls on a receiver that is not this, made while this is still on the
+ * stack just below it, as in "this.join(other.name())".  Only the call on
+ * this may be turned into an invokenonvirtual of Main.name.
+ */
+public class Main {
+  public Main() { super(); }
+
+  public String name() { return "main"; }
+
+  public String join(String s) { return "[" + s + "]"; }
+
+  public String show(Other o) {
+    return this.join(o.name()) + this.join(this.name());
+  }
+
+  public static void main(String[] args) {
+    Main m;
+    JoosIO io;
+    String line;
+    m = new Main();
+    io = new JoosIO();
+    line = io.readLine();
+    while (line != null) {
+      io.println(m.show(new Other(line)));
+      line = io.readLine();
+    }
+  }
+}
@@ -0,0 +1,7 @@
+public class Other {
+  protected String label;
+
+  public Other(String l) { super(); label = l; }
+
+  public String name() { return "other " + label; }
+}
@@ -0,0 +1,23 @@
+import joos.lib.*;
+
+public class Main {
+  public Main() { super(); }
+
+  public static void main(String[] args) {
+    JoosIO io;
+    Node list;
+    int n, i;
+    io = new JoosIO();
+    n = io.readInt();
+    while (n > 0) {
+      list = null;
+      i = 1;
+      while (i <= n) {
+        list = new Node(i * i, list);
+        i = i + 1;
+      }
+      io.println("" + list.last() + " " + list.sum(0) + " " + list.count(n));
+      n = io.readInt();
+    }
+  }
+}
@@ -0,0 +1,24 @@
+/* Recursion on a field rather than on this.  "return next.last()" calls
+ * the same method but on another receiver, so it is no tail call on this.
+ */
+public class Node {
+  protected int value;
+  protected Node next;
+
+  public Node(int v, Node n) { super(); value = v; next = n; }
+
+  public int last() {
+    if (next == null) return value;
+    return next.last();
+  }
+
+  public int sum(int acc) {
+    if (next == null) return acc + value;
+    return next.sum(acc + value);
+  }
+
+  public int count(int n) {
+    if (n <= 0) return value;
+    return this.count(n - 1);
+  }
+}
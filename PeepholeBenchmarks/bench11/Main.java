@@ -0,0 +1,56 @@
+import joos.lib.*;
+
+/* Stores that are only read along some cases of a switch.  Each chain of
+ * tests on x becomes a tableswitch or lookupswitch, and r = 0 is still
+ * needed by the cases that only add to r.
+ */
+public class Main {
+  public Main() { super(); }
+
+  public int dense(int x) {
+    int r;
+    r = 0;
+    if (x == 0) r = 1;
+    else if (x == 1) r = 2;
+    else if (x == 2) r = 3;
+    else if (x == 3) r = 4;
+    if (x == 0) r = r + 10;
+    else if (x == 1) r = r + 20;
+    else if (x == 2) r = r + 30;
+    else if (x == 3) r = r + 40;
+    else if (x == 4) r = r + 50;
+    return r;
+  }
+
+  public int chain(int x) {
+    int r;
+    r = 0;
+    if (x == 0) r = 1;
+    else if (x == 10) r = 2;
+    else if (x == 20) r = 3;
+    else if (x == 30) r = 4;
+    if (x == 0) r = r + 10;
+    else if (x == 10) r = r + 20;
+    else if (x == 20) r = r + 30;
+    else if (x == 30) r = r + 40;
+    else if (x == 40) r = r + 50;
+    else if (x == 50) r = r + 60;
+    else if (x == 60) r = r + 70;
+    else if (x == 70) r = r + 80;
+    else if (x == 80) r = r + 90;
+    return r;
+  }
+
+  public static void main(String[] args) {
+    Main m;
+    JoosIO io;
+    int x;
+    m = new Main();
+    io = new JoosIO();
+    x = io.readInt();
+    while (x >= 0) {
+      io.println("" + x + " " + m.dense(x) + " " + m.chain(x));
+      x = io.readInt();
+    }
+  }
+}
@@ -0,0 +1,5 @@
+public class A {
+  public A() { super(); }
+
+  public String toString() { return "A"; }
+}
@@ -0,0 +1,8 @@
+/* Overrides A.toString, which itself overrides Object.toString.  Only the
+ * library calls it, through Object.toString.
+ */
+public class B extends A {
+  public B() { super(); }
+
+  public String toString() { return "B"; }
+}
@@ -0,0 +1,22 @@
+import joos.lib.*;
+
+/* Methods that only the library calls, through a method of a library class
+ * that they override, possibly through a program class in between.
+ */
+public class Main {
+  public Main() { super(); }
+
+  public static void main(String[] args) {
+    JoosIO io;
+    A a, b;
+    String line;
+    io = new JoosIO();
+    a = new A();
+    b = new B();
+    line = io.readLine();
+    while (line != null) {
+      io.println(line + b + a + line);
+      line = io.readLine();
+    }
+  }
+}
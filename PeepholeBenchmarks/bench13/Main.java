@@ -0,0 +1,45 @@
+import joos.lib.*;
+
+/* Divisions whose results are never used.  Once the divisor is known to be
+ * a constant other than zero the division cannot throw and goes away with
+ * its operands; otherwise it stays, and so must every operand it loads.
+ */
+public class Main {
+  public Main() { super(); }
+
+  public int rem(int q) {
+    int d, e;
+    d = 1;
+    e = q % (d + 9);
+    return 63;
+  }
+
+  public int div(int q) {
+    int d, e;
+    d = 3;
+    e = (q + d) / (d * 2 - 1);
+    e = d / 3;
+    return q + 1;
+  }
+
+  public int kept(int q, int r) {
+    int d, e;
+    d = 4;
+    e = (d + q) / r;
+    e = d % (r + 1);
+    return q - r;
+  }
+
+  public static void main(String[] args) {
+    Main m;
+    JoosIO io;
+    int x;
+    m = new Main();
+    io = new JoosIO();
+    x = io.readInt();
+    while (x >= 0) {
+      io.println("" + m.rem(x) + " " + m.div(x) + " " + m.kept(x, x + 1));
+      x = io.readInt();
+    }
+  }
+}
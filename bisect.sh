@@ -0,0 +1,85 @@
+#!/bin/bash
+#
+# bisect: finds the first rewrite of the optimizer that breaks a benchmark.
+#
+# usage:  bisect.sh bench01 [test]
+#
+# The benchmark is compiled with -O -fopt-bisect-limit=N for varying N.
+# Compiling it with no rewrites must pass the test and with all of them it
+# must fail.  The test is a make target of the benchmark that fails when the
+# optimized program is wrong, "diff" by default; "run" only catches
+# programs that the JVM rejects.  For size or speed regressions give any
+# other shell command, which is run in the benchmark directory.
+
+PEEPDIR=`pwd`
+BENCH_DIR=PeepholeBenchmarks/$1
+TEST=${2:-diff}
+
+if [ -z "$1" ] || [ ! -d $BENCH_DIR ]
+then
+	echo "usage: bisect.sh benchNN [test]"
+	exit 1
+fi
+
+make -s -C JOOSA-src || exit 1
+
+# compiles with the first $1 rewrites and prints what the compiler says
+# about the bisection
+compile()
+{
+	PEEPDIR=$PEEPDIR make -s --no-print-directory -C $BENCH_DIR clean
+	PEEPDIR=$PEEPDIR make -s --no-print-directory -C $BENCH_DIR opt \
+		OPTFLAGS=-fopt-bisect-limit=$1 2> /dev/null | grep "^opt-bisect:"
+}
+
+# succeeds if the benchmark compiled with the first $1 rewrites passes
+passes()
+{
+	compile $1 > /dev/null
+	case $TEST in
+		diff|run)
+			PEEPDIR=$PEEPDIR make -s --no-print-directory -C $BENCH_DIR $TEST \
+				> /dev/null 2>&1 ;;
+		*)
+			(cd $BENCH_DIR && eval "$TEST") > /dev/null 2>&1 ;;
+	esac
+}
+
+TOTAL=$(compile 2147483647 | sed -n 's/^opt-bisect: \([0-9]*\) rewrites made$/\1/p')
+if [ -z "$TOTAL" ]
+then
+	echo "bisect: the compiler did not report its rewrites"
+	exit 1
+fi
+echo "bisect: $TOTAL rewrites in $1"
+
+if passes $TOTAL
+then
+	echo "bisect: $1 passes '$TEST' with every rewrite made"
+	exit 1
+fi
+if ! passes 0
+then
+	echo "bisect: $1 fails '$TEST' even without rewrites"
+	exit 1
+fi
+
+# invariant: LOW rewrites pass, HIGH rewrites fail
+LOW=0
+HIGH=$TOTAL
+while [ $((HIGH-LOW)) -gt 1 ]
+do
+	MID=$(((LOW+HIGH)/2))
+	if passes $MID
+	then
+		echo "bisect: $MID rewrites pass"
+		LOW=$MID
+	else
+		echo "bisect: $MID rewrites fail"
+		HIGH=$MID
+	fi
+done
+
+echo
+compile $HIGH | grep -v "rewrites made"
+echo "bisect: rebuild with 'make opt OPTFLAGS=-fopt-bisect-limit=$HIGH' to inspect it"
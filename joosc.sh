@@ -10,9 +10,16 @@
 PEEPDIR=`dirname $0`
 $PEEPDIR/joos.sh $*
 
+skip=0
 for f in $*
 do
-	if [[ $f != "-O" && ${f##*.} != "joos" ]]
+	if [[ $skip == 1 ]]
+	then
+		skip=0
+	elif [[ $f == "-R" || $f == "-C" || $f == "-T" ]]
+	then
+		skip=1
+	elif [[ $f != -* && ${f##*.} != "joos" ]]
 	then
 		NAME=${f%.*}
 		java -jar $PEEPDIR/jasmin.jar $NAME.j 